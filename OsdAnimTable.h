@@ -0,0 +1,391 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  OSD LOCK INDICATOR - Animation State Machine
+//
+//  PURPOSE:
+//    The whole OSD lifecycle as one constexpr table: state x event -> next
+//    state + a batch of actions (timers, alpha, present, window visibility).
+//    OsdLockIndicator.cpp applies the actions with Win32 calls; this header
+//    is plain C++ so the table is also replayed on Linux against a model of
+//    the timers and the window (tests/AnimTableTests.cpp).
+//
+//  VALIDATION:
+//    ValidateAnimTable() replays every legal entry against the timers, window
+//    visibility and presented alpha level (0, part-faded, opaque) each state
+//    implies, so a transition that would leave a stray timer running, kill a
+//    timer that isn't running, present a frame that is already on screen,
+//    skip a present the frame needs, or put stale content on screen fails
+//    the build instead of wasting wake-ups or showing the wrong text at
+//    runtime. The *_START states exist for this: a fade cut short before its
+//    first tick still holds alpha 0 or 255, and hides or returns to opaque
+//    without presenting.
+//
+//  STALE CONTENT:
+//    A show whose text is still being rendered uses the *_PENDING events.
+//    The window is not shown, made opaque, moved or animated until
+//    EV_CONTENT_READY - the PENDING states wait hidden, the STALE states wait
+//    with whatever was already on screen.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstdint>
+
+enum AnimationState {
+    STATE_HIDDEN,
+    STATE_FADE_IN_START,        // Shown at alpha 0, first fade-in tick not yet run
+    STATE_FADING_IN,
+    STATE_VISIBLE,
+    STATE_FADE_OUT_START,       // Still opaque, first fade-out tick not yet run
+    STATE_FADING_OUT,
+    STATE_PENDING_FADE_IN,      // Hidden, fades in once the content is ready
+    STATE_PENDING_INSTANT,      // Hidden, shows opaque once the content is ready
+    STATE_STALE_FADE_IN,        // Shown part-faded with old content, resumes fading in when ready
+    STATE_STALE_INSTANT,        // Shown part-faded with old content, goes opaque when ready
+    STATE_STALE_OPAQUE,         // Shown opaque with old content, stays opaque when ready
+    STATE_COUNT
+};
+
+enum AnimEvent {
+    EV_SHOW,                    // New indicator, fade mode (full or reduced)
+    EV_SHOW_INSTANT,            // New indicator, no fades
+    EV_SHOW_PENDING,            // EV_SHOW, but its content is still rendering
+    EV_SHOW_INSTANT_PENDING,    // EV_SHOW_INSTANT, but its content is still rendering
+    EV_SUPPRESS,                // New indicator, but presentation is suppressed
+    EV_FADE_STEP,               // TIMER_ANIM tick, target alpha not reached yet
+    EV_FADE_DONE,               // TIMER_ANIM tick reached the target alpha
+    EV_STAY_EXPIRED,            // TIMER_STAY fired, fade out
+    EV_HIDE_NOW,                // TIMER_STAY fired in instant mode
+    EV_CONTENT_READY,           // Worker swapped in freshly rendered content
+    EV_COUNT
+};
+
+enum AnimAction : uint32_t {
+    ACT_NONE            = 0,
+    ACT_KILL_ANIM       = 1 << 0,
+    ACT_KILL_STAY       = 1 << 1,
+    ACT_POSITION        = 1 << 2,   // CenterOnActiveMonitor
+    ACT_SET_ALPHA       = 1 << 3,   // Apply the alpha computed for this tick
+    ACT_OPAQUE          = 1 << 4,   // Alpha = 255
+    ACT_TRANSPARENT     = 1 << 5,   // Alpha = 0
+    ACT_PRESENT         = 1 << 6,   // UpdateLayeredWindow
+    ACT_SHOW_WINDOW     = 1 << 7,
+    ACT_HIDE_WINDOW     = 1 << 8,
+    ACT_START_ANIM      = 1 << 9,
+    ACT_RESTART_ANIM    = 1 << 10,  // SetTimer on a running timer resets it
+    ACT_START_STAY      = 1 << 11,
+    ACT_RESTART_STAY    = 1 << 12,
+};
+
+constexpr uint32_t ACT_ALPHA_MASK = ACT_SET_ALPHA | ACT_OPAQUE | ACT_TRANSPARENT;
+
+struct AnimTransition {
+    bool legal;
+    AnimationState next;
+    uint32_t actions;
+};
+
+constexpr AnimTransition Transition(AnimationState next, uint32_t actions) { return { true, next, actions }; }
+constexpr AnimTransition ILLEGAL = { false, STATE_HIDDEN, ACT_NONE };
+
+constexpr uint32_t SHOW_FADE_FROM_HIDDEN = ACT_POSITION | ACT_SHOW_WINDOW | ACT_START_ANIM;
+constexpr uint32_t SHOW_OPAQUE_FROM_HIDDEN = ACT_POSITION | ACT_OPAQUE | ACT_PRESENT | ACT_SHOW_WINDOW | ACT_START_STAY;
+constexpr uint32_t SHOW_OPAQUE_FROM_ANIM = ACT_KILL_ANIM | ACT_POSITION | ACT_OPAQUE | ACT_PRESENT | ACT_START_STAY;
+constexpr uint32_t SHOW_OPAQUE_FROM_STALE = ACT_POSITION | ACT_OPAQUE | ACT_PRESENT | ACT_START_STAY;
+constexpr uint32_t SHOW_FADE_FROM_STALE = ACT_POSITION | ACT_PRESENT | ACT_START_ANIM;     // New content at the current alpha
+constexpr uint32_t SHOW_CONTENT_WHEN_OPAQUE = ACT_POSITION | ACT_PRESENT | ACT_START_STAY;
+constexpr uint32_t HIDE_FROM_ANIM = ACT_KILL_ANIM | ACT_TRANSPARENT | ACT_PRESENT | ACT_HIDE_WINDOW;
+constexpr uint32_t HIDE_FROM_STAY = ACT_KILL_STAY | ACT_TRANSPARENT | ACT_PRESENT | ACT_HIDE_WINDOW;
+constexpr uint32_t HIDE_FROM_STALE = ACT_TRANSPARENT | ACT_PRESENT | ACT_HIDE_WINDOW;
+constexpr uint32_t HIDE_AT_ZERO = ACT_KILL_ANIM | ACT_HIDE_WINDOW;                       // Already transparent
+
+constexpr AnimTransition ANIM_TABLE[STATE_COUNT][EV_COUNT] = {
+    // STATE_HIDDEN
+    {
+        /* EV_SHOW                 */ Transition(STATE_FADE_IN_START, SHOW_FADE_FROM_HIDDEN),
+        /* EV_SHOW_INSTANT         */ Transition(STATE_VISIBLE, SHOW_OPAQUE_FROM_HIDDEN),
+        /* EV_SHOW_PENDING         */ Transition(STATE_PENDING_FADE_IN, ACT_NONE),
+        /* EV_SHOW_INSTANT_PENDING */ Transition(STATE_PENDING_INSTANT, ACT_NONE),
+        /* EV_SUPPRESS             */ Transition(STATE_HIDDEN, ACT_NONE),
+        /* EV_FADE_STEP            */ ILLEGAL,
+        /* EV_FADE_DONE            */ ILLEGAL,
+        /* EV_STAY_EXPIRED         */ ILLEGAL,
+        /* EV_HIDE_NOW             */ ILLEGAL,
+        /* EV_CONTENT_READY        */ Transition(STATE_HIDDEN, ACT_NONE),
+    },
+    // STATE_FADE_IN_START
+    {
+        /* EV_SHOW                 */ Transition(STATE_VISIBLE, SHOW_OPAQUE_FROM_ANIM),
+        /* EV_SHOW_INSTANT         */ Transition(STATE_VISIBLE, SHOW_OPAQUE_FROM_ANIM),
+        /* EV_SHOW_PENDING         */ Transition(STATE_PENDING_FADE_IN, HIDE_AT_ZERO),
+        /* EV_SHOW_INSTANT_PENDING */ Transition(STATE_PENDING_INSTANT, HIDE_AT_ZERO),
+        /* EV_SUPPRESS             */ Transition(STATE_HIDDEN, HIDE_AT_ZERO),
+        /* EV_FADE_STEP            */ Transition(STATE_FADING_IN, ACT_SET_ALPHA | ACT_PRESENT),
+        /* EV_FADE_DONE            */ Transition(STATE_VISIBLE, ACT_KILL_ANIM | ACT_OPAQUE | ACT_PRESENT | ACT_START_STAY),
+        /* EV_STAY_EXPIRED         */ ILLEGAL,
+        /* EV_HIDE_NOW             */ ILLEGAL,
+        /* EV_CONTENT_READY        */ Transition(STATE_FADE_IN_START, ACT_NONE),    // Invisible at alpha 0
+    },
+    // STATE_FADING_IN
+    {
+        /* EV_SHOW                 */ Transition(STATE_VISIBLE, SHOW_OPAQUE_FROM_ANIM),
+        /* EV_SHOW_INSTANT         */ Transition(STATE_VISIBLE, SHOW_OPAQUE_FROM_ANIM),
+        /* EV_SHOW_PENDING         */ Transition(STATE_STALE_FADE_IN, ACT_KILL_ANIM),
+        /* EV_SHOW_INSTANT_PENDING */ Transition(STATE_STALE_INSTANT, ACT_KILL_ANIM),
+        /* EV_SUPPRESS             */ Transition(STATE_HIDDEN, HIDE_FROM_ANIM),
+        /* EV_FADE_STEP            */ Transition(STATE_FADING_IN, ACT_SET_ALPHA | ACT_PRESENT),
+        /* EV_FADE_DONE            */ Transition(STATE_VISIBLE, ACT_KILL_ANIM | ACT_OPAQUE | ACT_PRESENT | ACT_START_STAY),
+        /* EV_STAY_EXPIRED         */ ILLEGAL,
+        /* EV_HIDE_NOW             */ ILLEGAL,
+        /* EV_CONTENT_READY        */ Transition(STATE_FADING_IN, ACT_PRESENT),
+    },
+    // STATE_VISIBLE
+    {
+        /* EV_SHOW                 */ Transition(STATE_VISIBLE, ACT_POSITION | ACT_RESTART_STAY),
+        /* EV_SHOW_INSTANT         */ Transition(STATE_VISIBLE, ACT_POSITION | ACT_RESTART_STAY),
+        /* EV_SHOW_PENDING         */ Transition(STATE_STALE_OPAQUE, ACT_KILL_STAY),
+        /* EV_SHOW_INSTANT_PENDING */ Transition(STATE_STALE_OPAQUE, ACT_KILL_STAY),
+        /* EV_SUPPRESS             */ Transition(STATE_HIDDEN, HIDE_FROM_STAY),
+        /* EV_FADE_STEP            */ ILLEGAL,
+        /* EV_FADE_DONE            */ ILLEGAL,
+        /* EV_STAY_EXPIRED         */ Transition(STATE_FADE_OUT_START, ACT_KILL_STAY | ACT_START_ANIM),
+        /* EV_HIDE_NOW             */ Transition(STATE_HIDDEN, HIDE_FROM_STAY),
+        /* EV_CONTENT_READY        */ Transition(STATE_VISIBLE, ACT_PRESENT),
+    },
+    // STATE_FADE_OUT_START
+    {
+        /* EV_SHOW                 */ Transition(STATE_VISIBLE, ACT_KILL_ANIM | ACT_POSITION | ACT_START_STAY),    // Still opaque
+        /* EV_SHOW_INSTANT         */ Transition(STATE_VISIBLE, ACT_KILL_ANIM | ACT_POSITION | ACT_START_STAY),
+        /* EV_SHOW_PENDING         */ Transition(STATE_STALE_OPAQUE, ACT_KILL_ANIM),
+        /* EV_SHOW_INSTANT_PENDING */ Transition(STATE_STALE_OPAQUE, ACT_KILL_ANIM),
+        /* EV_SUPPRESS             */ Transition(STATE_HIDDEN, HIDE_FROM_ANIM),
+        /* EV_FADE_STEP            */ Transition(STATE_FADING_OUT, ACT_SET_ALPHA | ACT_PRESENT),
+        /* EV_FADE_DONE            */ Transition(STATE_HIDDEN, HIDE_FROM_ANIM),
+        /* EV_STAY_EXPIRED         */ ILLEGAL,
+        /* EV_HIDE_NOW             */ ILLEGAL,
+        /* EV_CONTENT_READY        */ Transition(STATE_FADE_OUT_START, ACT_PRESENT),
+    },
+    // STATE_FADING_OUT
+    {
+        /* EV_SHOW                 */ Transition(STATE_FADING_IN, ACT_POSITION | ACT_RESTART_ANIM),
+        /* EV_SHOW_INSTANT         */ Transition(STATE_VISIBLE, SHOW_OPAQUE_FROM_ANIM),
+        /* EV_SHOW_PENDING         */ Transition(STATE_STALE_FADE_IN, ACT_KILL_ANIM),
+        /* EV_SHOW_INSTANT_PENDING */ Transition(STATE_STALE_INSTANT, ACT_KILL_ANIM),
+        /* EV_SUPPRESS             */ Transition(STATE_HIDDEN, HIDE_FROM_ANIM),
+        /* EV_FADE_STEP            */ Transition(STATE_FADING_OUT, ACT_SET_ALPHA | ACT_PRESENT),
+        /* EV_FADE_DONE            */ Transition(STATE_HIDDEN, HIDE_FROM_ANIM),
+        /* EV_STAY_EXPIRED         */ ILLEGAL,
+        /* EV_HIDE_NOW             */ ILLEGAL,
+        /* EV_CONTENT_READY        */ Transition(STATE_FADING_OUT, ACT_PRESENT),
+    },
+    // STATE_PENDING_FADE_IN
+    {
+        /* EV_SHOW                 */ Transition(STATE_FADE_IN_START, SHOW_FADE_FROM_HIDDEN),
+        /* EV_SHOW_INSTANT         */ Transition(STATE_VISIBLE, SHOW_OPAQUE_FROM_HIDDEN),
+        /* EV_SHOW_PENDING         */ Transition(STATE_PENDING_FADE_IN, ACT_NONE),
+        /* EV_SHOW_INSTANT_PENDING */ Transition(STATE_PENDING_INSTANT, ACT_NONE),
+        /* EV_SUPPRESS             */ Transition(STATE_HIDDEN, ACT_NONE),
+        /* EV_FADE_STEP            */ ILLEGAL,
+        /* EV_FADE_DONE            */ ILLEGAL,
+        /* EV_STAY_EXPIRED         */ ILLEGAL,
+        /* EV_HIDE_NOW             */ ILLEGAL,
+        /* EV_CONTENT_READY        */ Transition(STATE_FADE_IN_START, SHOW_FADE_FROM_HIDDEN),
+    },
+    // STATE_PENDING_INSTANT
+    {
+        /* EV_SHOW                 */ Transition(STATE_FADE_IN_START, SHOW_FADE_FROM_HIDDEN),
+        /* EV_SHOW_INSTANT         */ Transition(STATE_VISIBLE, SHOW_OPAQUE_FROM_HIDDEN),
+        /* EV_SHOW_PENDING         */ Transition(STATE_PENDING_FADE_IN, ACT_NONE),
+        /* EV_SHOW_INSTANT_PENDING */ Transition(STATE_PENDING_INSTANT, ACT_NONE),
+        /* EV_SUPPRESS             */ Transition(STATE_HIDDEN, ACT_NONE),
+        /* EV_FADE_STEP            */ ILLEGAL,
+        /* EV_FADE_DONE            */ ILLEGAL,
+        /* EV_STAY_EXPIRED         */ ILLEGAL,
+        /* EV_HIDE_NOW             */ ILLEGAL,
+        /* EV_CONTENT_READY        */ Transition(STATE_VISIBLE, SHOW_OPAQUE_FROM_HIDDEN),
+    },
+    // STATE_STALE_FADE_IN
+    {
+        /* EV_SHOW                 */ Transition(STATE_FADING_IN, SHOW_FADE_FROM_STALE),
+        /* EV_SHOW_INSTANT         */ Transition(STATE_VISIBLE, SHOW_OPAQUE_FROM_STALE),
+        /* EV_SHOW_PENDING         */ Transition(STATE_STALE_FADE_IN, ACT_NONE),
+        /* EV_SHOW_INSTANT_PENDING */ Transition(STATE_STALE_INSTANT, ACT_NONE),
+        /* EV_SUPPRESS             */ Transition(STATE_HIDDEN, HIDE_FROM_STALE),
+        /* EV_FADE_STEP            */ ILLEGAL,
+        /* EV_FADE_DONE            */ ILLEGAL,
+        /* EV_STAY_EXPIRED         */ ILLEGAL,
+        /* EV_HIDE_NOW             */ ILLEGAL,
+        /* EV_CONTENT_READY        */ Transition(STATE_FADING_IN, SHOW_FADE_FROM_STALE),
+    },
+    // STATE_STALE_INSTANT
+    {
+        /* EV_SHOW                 */ Transition(STATE_FADING_IN, SHOW_FADE_FROM_STALE),
+        /* EV_SHOW_INSTANT         */ Transition(STATE_VISIBLE, SHOW_OPAQUE_FROM_STALE),
+        /* EV_SHOW_PENDING         */ Transition(STATE_STALE_FADE_IN, ACT_NONE),
+        /* EV_SHOW_INSTANT_PENDING */ Transition(STATE_STALE_INSTANT, ACT_NONE),
+        /* EV_SUPPRESS             */ Transition(STATE_HIDDEN, HIDE_FROM_STALE),
+        /* EV_FADE_STEP            */ ILLEGAL,
+        /* EV_FADE_DONE            */ ILLEGAL,
+        /* EV_STAY_EXPIRED         */ ILLEGAL,
+        /* EV_HIDE_NOW             */ ILLEGAL,
+        /* EV_CONTENT_READY        */ Transition(STATE_VISIBLE, SHOW_OPAQUE_FROM_STALE),
+    },
+    // STATE_STALE_OPAQUE
+    {
+        /* EV_SHOW                 */ Transition(STATE_VISIBLE, SHOW_CONTENT_WHEN_OPAQUE),
+        /* EV_SHOW_INSTANT         */ Transition(STATE_VISIBLE, SHOW_CONTENT_WHEN_OPAQUE),
+        /* EV_SHOW_PENDING         */ Transition(STATE_STALE_OPAQUE, ACT_NONE),
+        /* EV_SHOW_INSTANT_PENDING */ Transition(STATE_STALE_OPAQUE, ACT_NONE),
+        /* EV_SUPPRESS             */ Transition(STATE_HIDDEN, HIDE_FROM_STALE),
+        /* EV_FADE_STEP            */ ILLEGAL,
+        /* EV_FADE_DONE            */ ILLEGAL,
+        /* EV_STAY_EXPIRED         */ ILLEGAL,
+        /* EV_HIDE_NOW             */ ILLEGAL,
+        /* EV_CONTENT_READY        */ Transition(STATE_VISIBLE, SHOW_CONTENT_WHEN_OPAQUE),
+    },
+};
+
+// Looks up what an event does in a state. Pure - applying the actions is up to the caller.
+constexpr AnimTransition Step(AnimationState state, AnimEvent event)
+{
+    return (state >= 0 && state < STATE_COUNT && event >= 0 && event < EV_COUNT) ? ANIM_TABLE[state][event] : ILLEGAL;
+}
+
+// What each state implies: which timers run, whether the window is shown,
+// whether the newest content is still being rendered, and the alpha of the
+// frame last handed to UpdateLayeredWindow
+constexpr bool AnimTimerRunsIn(AnimationState state)
+{
+    return state == STATE_FADE_IN_START || state == STATE_FADING_IN ||
+        state == STATE_FADE_OUT_START || state == STATE_FADING_OUT;
+}
+constexpr bool StayTimerRunsIn(AnimationState state) { return state == STATE_VISIBLE; }
+constexpr bool FadesIn(AnimationState state) { return state == STATE_FADE_IN_START || state == STATE_FADING_IN; }
+constexpr bool WindowShownIn(AnimationState state)
+{
+    return AnimTimerRunsIn(state) || state == STATE_VISIBLE || state == STATE_STALE_FADE_IN ||
+        state == STATE_STALE_INSTANT || state == STATE_STALE_OPAQUE;
+}
+constexpr bool StaleShownIn(AnimationState state)
+{
+    return state == STATE_STALE_FADE_IN || state == STATE_STALE_INSTANT || state == STATE_STALE_OPAQUE;
+}
+constexpr bool ContentPendingIn(AnimationState state)
+{
+    return state == STATE_PENDING_FADE_IN || state == STATE_PENDING_INSTANT || StaleShownIn(state);
+}
+
+// Every fade tick moves alpha by at least one step, so two PARTIAL frames
+// from consecutive ticks always differ
+enum AlphaLevel { ALPHA_ZERO, ALPHA_PARTIAL, ALPHA_OPAQUE };
+
+constexpr AlphaLevel PresentedAlphaIn(AnimationState state)
+{
+    switch (state) {
+    case STATE_FADING_IN:
+    case STATE_FADING_OUT:
+    case STATE_STALE_FADE_IN:
+    case STATE_STALE_INSTANT:   return ALPHA_PARTIAL;
+    case STATE_VISIBLE:
+    case STATE_FADE_OUT_START:
+    case STATE_STALE_OPAQUE:    return ALPHA_OPAQUE;
+    default:                    return ALPHA_ZERO;
+    }
+}
+
+constexpr bool IsPendingShowEvent(AnimEvent event) { return event == EV_SHOW_PENDING || event == EV_SHOW_INSTANT_PENDING; }
+
+constexpr bool IsValidTransition(AnimationState from, AnimEvent event, AnimTransition t)
+{
+    if (!t.legal) return true;
+    uint32_t a = t.actions;
+
+    // Timers: kills/restarts need a running timer, starts need a stopped one,
+    // and the result must be exactly what the next state implies
+    bool anim = AnimTimerRunsIn(from);
+    bool stay = StayTimerRunsIn(from);
+    if ((a & ACT_KILL_ANIM) && !anim) return false;
+    if ((a & ACT_KILL_STAY) && !stay) return false;
+    if (a & ACT_KILL_ANIM) anim = false;
+    if (a & ACT_KILL_STAY) stay = false;
+    if ((a & ACT_RESTART_ANIM) && !anim) return false;
+    if ((a & ACT_RESTART_STAY) && !stay) return false;
+    if ((a & ACT_START_ANIM) && anim) return false;
+    if ((a & ACT_START_STAY) && stay) return false;
+    if (a & ACT_START_ANIM) anim = true;
+    if (a & ACT_START_STAY) stay = true;
+    if (anim != AnimTimerRunsIn(t.next) || stay != StayTimerRunsIn(t.next)) return false;
+
+    // Window: only show a hidden window, only hide a shown one
+    bool shown = WindowShownIn(from);
+    if ((a & ACT_SHOW_WINDOW) && shown) return false;
+    if ((a & ACT_HIDE_WINDOW) && !shown) return false;
+    if (a & ACT_SHOW_WINDOW) shown = true;
+    if (a & ACT_HIDE_WINDOW) shown = false;
+    if (shown != WindowShownIn(t.next)) return false;
+
+    // Presents: at most one alpha change, the alpha must end where the next
+    // state says, and present exactly when the frame changes - a new alpha
+    // level, another fade tick, or new content that isn't fully transparent
+    uint32_t alpha = a & ACT_ALPHA_MASK;
+    if (alpha & (alpha - 1)) return false;
+    AlphaLevel level = PresentedAlphaIn(from);
+    if (alpha == ACT_SET_ALPHA) level = ALPHA_PARTIAL;
+    if (alpha == ACT_OPAQUE) level = ALPHA_OPAQUE;
+    if (alpha == ACT_TRANSPARENT) level = ALPHA_ZERO;
+    if (level != PresentedAlphaIn(t.next)) return false;
+    bool newContent = event == EV_CONTENT_READY || (StaleShownIn(from) && !ContentPendingIn(t.next));
+    bool changed = level != PresentedAlphaIn(from) || alpha == ACT_SET_ALPHA ||
+        (newContent && level != ALPHA_ZERO);
+    if (((a & ACT_PRESENT) != 0) != changed) return false;
+
+    // Stale content: until EV_CONTENT_READY (or a show whose content is
+    // current) nothing may be shown, made more visible, moved or timed -
+    // only hidden. And the waiting states are only entered with stale content.
+    bool stale = IsPendingShowEvent(event) ||
+        (ContentPendingIn(from) && event != EV_CONTENT_READY && event != EV_SHOW && event != EV_SHOW_INSTANT);
+    if (stale) {
+        constexpr uint32_t REVEALS = ACT_POSITION | ACT_SET_ALPHA | ACT_OPAQUE | ACT_SHOW_WINDOW |
+            ACT_START_ANIM | ACT_RESTART_ANIM | ACT_START_STAY | ACT_RESTART_STAY;
+        if (a & REVEALS) return false;
+        if (t.next != STATE_HIDDEN && !ContentPendingIn(t.next)) return false;
+    }
+    else if (ContentPendingIn(t.next)) {
+        return false;
+    }
+
+    return true;
+}
+
+// Events that can arrive at any time must be handled in every state; timer
+// events must be handled exactly where their timer runs
+constexpr bool IsCoveredTransition(AnimationState state, AnimEvent event, AnimTransition t)
+{
+    switch (event) {
+    case EV_FADE_STEP:
+    case EV_FADE_DONE:      return t.legal == AnimTimerRunsIn(state);
+    case EV_STAY_EXPIRED:
+    case EV_HIDE_NOW:       return t.legal == StayTimerRunsIn(state);
+    default:                return t.legal;
+    }
+}
+
+constexpr bool ValidateAnimTable()
+{
+    for (int state = 0; state < STATE_COUNT; state++) {
+        for (int event = 0; event < EV_COUNT; event++) {
+            auto from = static_cast<AnimationState>(state);
+            auto ev = static_cast<AnimEvent>(event);
+            if (!IsValidTransition(from, ev, ANIM_TABLE[state][event]) ||
+                !IsCoveredTransition(from, ev, ANIM_TABLE[state][event])) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static_assert(ValidateAnimTable(), "ANIM_TABLE has a transition that leaks or double-starts a timer, "
+    "mismatches window visibility or alpha, presents a frame already on screen (or misses a change), "
+    "reveals stale content, or leaves an event unhandled");
@@ -15,8 +15,10 @@
 //      ❌ Log any keystrokes
 //      ❌ Capture passwords or sensitive data  
 //      ❌ Send any data over the network
-//      ❌ Store any information to disk
-//      ❌ Monitor anything except VK_CAPITAL and VK_NUMLOCK
+//      ❌ Store any information to disk (the only exception is a timing-only
+//         diagnostic trace, written when you run /dumptrace)
+//      ❌ Monitor anything except VK_CAPITAL, VK_NUMLOCK and keys
+//         registered by plugins you install yourself (see OsdPluginApi.h)
 //
 //  Author: Dope M.S.R. (github.com/DopeMSR)
 //  License: MIT - Open Source
@@ -29,11 +31,20 @@
 #include <gdiplus.h>
 #include <tlhelp32.h>
 #include <psapi.h>
+#include <shellapi.h>
 
 #pragma comment(lib, "user32.lib")
 #pragma comment(lib, "gdi32.lib")
 #pragma comment(lib, "gdiplus.lib")
 #pragma comment(lib, "psapi.lib")
+#pragma comment(lib, "shell32.lib")
+
+#include "OsdAnimTable.h"
+#include "OsdPluginApi.h"
+#include "OsdPluginHost.h"
+#include "OsdPresentPolicy.h"
+#include "OsdRenderQueue.h"
+#include "OsdTrace.h"
 
 using namespace Gdiplus;
 
@@ -90,6 +101,13 @@ constexpr int ANIM_INTERVAL = 10;     // Milliseconds between animation frames
 constexpr int DISPLAY_TIME = 1500;   // How long to show before fading out (milliseconds)
 constexpr bool EASE_ANIMATION = true;   // true = smooth easing, false = linear fade
 
+// =============================================================================
+// FULLSCREEN & POWER BEHAVIOR
+// =============================================================================
+
+constexpr bool GAME_AWARE_PRESENTATION = true;  // Tone down animation over fullscreen apps / on battery
+constexpr int REDUCED_ANIM_INTERVAL = 33;     // Milliseconds between frames in reduced mode (~30 Hz)
+
 // =============================================================================
 // FONT SETTINGS
 // =============================================================================
@@ -108,43 +126,112 @@ const wchar_t* const FONT_NAME = L"Segoe UI";  // Font family name
 // Internal State & Constants
 // =============================================================================
 
-enum AnimationState { STATE_HIDDEN, STATE_FADING_IN, STATE_VISIBLE, STATE_FADING_OUT };
-
+// Lifecycle state - the transition table is in OsdAnimTable.h and
+// DispatchAnimEvent() applies its actions with Win32 calls
 AnimationState g_animState = STATE_HIDDEN;
 int g_currentAlpha = 0;
 
 HWND g_hwndOSD = NULL;
 HHOOK g_keyboardHook = NULL;
 wchar_t g_text[64] = { 0 };
+bool g_textIsOn = false;
 ULONG_PTR g_gdiplusToken;
 
 constexpr UINT_PTR TIMER_ANIM = 1;
 constexpr UINT_PTR TIMER_STAY = 2;
 constexpr UINT WM_KEYSTATE_CHANGED = WM_USER + 1;
+constexpr UINT WM_RENDER_COMPLETE = WM_USER + 2;
+constexpr UINT WM_PLUGIN_EVENT = WM_USER + 3;
+constexpr UINT WM_DUMP_TRACE = WM_USER + 4;
 
 // =============================================================================
-// RAII Wrappers for GDI Resources (automatic cleanup)
+// Presentation Policy (fullscreen / power aware)
 // =============================================================================
+// Enums, table and evaluator live in OsdPresentPolicy.h; the Win32 inputs are
+// queried in QueryForegroundState() / QueryPowerState() below.
 
-struct ScreenDCReleaser {
-    HDC hdc;
-    ~ScreenDCReleaser() { if (hdc) ReleaseDC(NULL, hdc); }
+static_assert(!GAME_AWARE_PRESENTATION ||
+    EvaluatePresentPolicy(FG_NORMAL, POWER_AC, GAME_AWARE_PRESENTATION) == PRESENT_FULL,
+    "Normal desktop use on AC power must keep the full animation");
+
+PresentMode g_presentMode = PRESENT_FULL;
+PresentStats g_presentStats;
+
+// =============================================================================
+// Plugin Indicators & Key Filter
+// =============================================================================
+// Registration, the key filter and dispatch live in OsdPluginHost.h.
+
+PluginRegistry g_plugins;                 // Also holds the built-in lock keys
+
+HMODULE g_pluginModules[OSD_MAX_INDICATORS] = {};
+int g_pluginModuleCount = 0;
+bool g_pluginsLoading = false;
+
+// =============================================================================
+// Double-Buffered Render Surfaces
+// =============================================================================
+// New content is drawn by a worker thread into the back surface (a premultiplied
+// 32bpp DIB). The UI thread only swaps surfaces and calls UpdateLayeredWindow, so
+// alpha-only animation frames never wait for GDI+ text rendering. Which surface
+// is front, and whether a finished frame is still current, is decided by
+// RenderQueue (OsdRenderQueue.h); the code here only adapts it to Win32.
+
+struct RenderSurface {
+    HDC hdc;           // Memory DC owned by the UI thread
+    HBITMAP hbm;       // Top-down 32bpp DIB section
+    HGDIOBJ hOld;      // Bitmap originally selected into hdc
+    void* bits;        // Pixel memory written by the worker
 };
 
-struct MemoryDCDeleter {
-    HDC hdc;
-    ~MemoryDCDeleter() { if (hdc) DeleteDC(hdc); }
+struct RenderRequest {
+    wchar_t text[64];
+    bool isOn;
 };
 
-struct BitmapDeleter {
-    HBITMAP hbm;
-    ~BitmapDeleter() { if (hbm) DeleteObject(hbm); }
+RenderSurface g_surfaces[2] = {};
+RenderQueue<RenderRequest> g_renderQueue;
+HANDLE g_renderThread = NULL;
+
+// =============================================================================
+// Lifecycle Trace (always on, fixed-size ring)
+// =============================================================================
+// Ring and exporter live in OsdTrace.h; Win32 supplies the clock and thread ids.
+
+struct Win32TracePlatform {
+    static int64_t Now()
+    {
+        LARGE_INTEGER now;
+        QueryPerformanceCounter(&now);
+        return now.QuadPart;
+    }
+
+    static int64_t Frequency()
+    {
+        LARGE_INTEGER frequency;
+        QueryPerformanceFrequency(&frequency);
+        return frequency.QuadPart;
+    }
+
+    static uint32_t ThreadId() { return GetCurrentThreadId(); }
 };
 
-struct GdiPlusObjectSelector {
+TraceRing<Win32TracePlatform, 2048> g_trace;   // 64 KB
+DWORD g_uiThreadId = 0;
+DWORD g_renderThreadId = 0;
+
+inline void Trace(TraceEvent event, DWORD arg = 0)
+{
+    g_trace.Record(event, arg);
+}
+
+// =============================================================================
+// RAII Wrappers for GDI Resources (automatic cleanup)
+// =============================================================================
+
+struct ScreenDCReleaser {
     HDC hdc;
-    HGDIOBJ hOld;
-    ~GdiPlusObjectSelector() { if (hdc && hOld) SelectObject(hdc, hOld); }
+    ~ScreenDCReleaser() { if (hdc) ReleaseDC(NULL, hdc); }
 };
 
 // =============================================================================
@@ -154,8 +241,24 @@ struct GdiPlusObjectSelector {
 LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam);
 LRESULT CALLBACK KeyboardProc(int nCode, WPARAM wParam, LPARAM lParam);
 void UpdateOSD();
+void RequestRender();
+bool CreateRenderSurfaces();
+void DestroyRenderSurfaces();
+bool StartRenderWorker();
+void StopRenderWorker();
+DWORD WINAPI RenderWorkerProc(LPVOID param);
 void CenterOnActiveMonitor(HWND hwnd);
+ForegroundState QueryForegroundState();
+PowerState QueryPowerState();
 void ShowIndicator();
+void SetIndicatorText(const wchar_t* label, const wchar_t* status, bool isOn);
+void LoadPlugins();
+void UnloadPlugins();
+bool DispatchPluginKey(UINT vkCode);
+void SetAnimState(AnimationState state);
+void DispatchAnimEvent(AnimEvent event, int stepAlpha = 0);
+bool DumpTrace(const wchar_t* path);
+bool GetTracePath(wchar_t* path, DWORD size);
 bool RemoveFromStartup();
 void CleanupAllSettings();
 bool IsInStartup();
@@ -196,21 +299,29 @@ bool ContainsArgInsensitive(const char* haystack, const char* needle)
 // Animation Easing Function
 // =============================================================================
 
+inline int CurrentAnimInterval()
+{
+    return (g_presentMode == PRESENT_REDUCED) ? REDUCED_ANIM_INTERVAL : ANIM_INTERVAL;
+}
+
 inline int CalculateNextAlpha(int current, int target, bool fadeIn)
 {
+    // Scale the step with the frame interval so reduced-rate fades take the same time
+    float speed = static_cast<float>(FADE_SPEED) * CurrentAnimInterval() / ANIM_INTERVAL;
+
     if (!EASE_ANIMATION) {
         // Linear animation
         if (fadeIn) {
-            return min(current + FADE_SPEED, target);
+            return min(current + static_cast<int>(speed), target);
         }
         else {
-            return max(current - FADE_SPEED, target);
+            return max(current - static_cast<int>(speed), target);
         }
     }
 
     // Ease-out quadratic for smooth deceleration
     float progress = static_cast<float>(abs(target - current)) / 255.0f;
-    int step = static_cast<int>(FADE_SPEED * (0.5f + progress * 1.5f));
+    int step = static_cast<int>(speed * (0.5f + progress * 1.5f));
     step = max(step, 3); // Minimum step to ensure animation completes
 
     if (fadeIn) {
@@ -379,6 +490,45 @@ void MarkSetupCompleted()
     }
 }
 
+// =============================================================================
+// Trace Export (Chrome / Perfetto JSON)
+// =============================================================================
+
+bool GetTracePath(wchar_t* path, DWORD size)
+{
+    DWORD len = GetTempPathW(size, path);
+    if (len == 0 || len >= size) return false;
+    return wcscat_s(path, size, L"OsdLockIndicator-trace.json") == 0;
+}
+
+bool DumpTrace(const wchar_t* path)
+{
+    // Per-mode frame counts since startup go in the metadata block
+    char otherData[256];
+    int len = wsprintfA(otherData, "\"presentedFrames\":{");
+    for (int mode = 0; mode < PRESENT_MODE_COUNT; mode++) {
+        len += wsprintfA(otherData + len, "%s\"%s\":%I64u", mode ? "," : "",
+            PresentModeName(static_cast<PresentMode>(mode)), g_presentStats.frames[mode]);
+    }
+    wsprintfA(otherData + len, "},\"droppedEvents\":%I64u", g_trace.Dropped());
+
+    const TraceThreadName threads[] = {
+        { static_cast<uint32_t>(g_uiThreadId), "UI" },
+        { static_cast<uint32_t>(g_renderThreadId), "Render worker" },
+    };
+    std::string json = g_trace.ExportJson(threads, 2, otherData);
+
+    HANDLE hFile = CreateFileW(path, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (hFile == INVALID_HANDLE_VALUE) return false;
+
+    DWORD written = 0;
+    bool ok = WriteFile(hFile, json.data(), static_cast<DWORD>(json.size()), &written, NULL) &&
+        written == json.size();
+
+    CloseHandle(hFile);
+    return ok;
+}
+
 // =============================================================================
 // Main Entry Point
 // =============================================================================
@@ -392,6 +542,32 @@ int WINAPI WinMain(
     UNREFERENCED_PARAMETER(hPrevInstance);
     UNREFERENCED_PARAMETER(nShowCmd);
 
+    // --- Handle Dump Trace Command (case-insensitive) ---
+    if (ContainsArgInsensitive(lpCmdLine, "/dumptrace") ||
+        ContainsArgInsensitive(lpCmdLine, "--dumptrace") ||
+        ContainsArgInsensitive(lpCmdLine, "-dumptrace")) {
+
+        HWND hwndRunning = FindWindowW(L"OsdLockIndicatorClass", NULL);
+        DWORD_PTR dumped = 0;
+        wchar_t tracePath[MAX_PATH];
+
+        if (hwndRunning && GetTracePath(tracePath, MAX_PATH) &&
+            SendMessageTimeoutW(hwndRunning, WM_DUMP_TRACE, 0, 0, SMTO_ABORTIFHUNG, 5000, &dumped) && dumped) {
+            wchar_t message[MAX_PATH + 128];
+            wcscpy_s(message, MAX_PATH + 128, L"Trace written to:\n\n");
+            wcscat_s(message, MAX_PATH + 128, tracePath);
+            wcscat_s(message, MAX_PATH + 128, L"\n\nOpen it in ui.perfetto.dev or chrome://tracing.");
+            MessageBoxW(NULL, message, L"OSD Lock Indicator - Trace", MB_OK | MB_ICONINFORMATION);
+        }
+        else {
+            MessageBoxW(NULL,
+                L"Could not get a trace. Make sure OSD Lock Indicator is running.",
+                L"OSD Lock Indicator - Trace",
+                MB_OK | MB_ICONWARNING);
+        }
+        return 0;
+    }
+
     // --- Handle Uninstall Command (case-insensitive) ---
     if (ContainsArgInsensitive(lpCmdLine, "/uninstall") ||
         ContainsArgInsensitive(lpCmdLine, "--uninstall") ||
@@ -481,6 +657,17 @@ int WINAPI WinMain(
         return 0;
     }
 
+    // --- Start Background Renderer ---
+    g_trace.SetBase(Win32TracePlatform::Now());
+    g_uiThreadId = GetCurrentThreadId();
+
+    if (!CreateRenderSurfaces() || !StartRenderWorker()) {
+        DestroyRenderSurfaces();
+        GdiplusShutdown(g_gdiplusToken);
+        if (mutex) { ReleaseMutex(mutex); CloseHandle(mutex); }
+        return 1;
+    }
+
     // --- First Run: Ask User About Windows Startup ---
     if (!HasCompletedSetup()) {
         int result = MessageBoxW(NULL,
@@ -520,8 +707,12 @@ int WINAPI WinMain(
     g_currentAlpha = 0;
     UpdateOSD();
 
+    // --- Load Plugins (must finish before the hook reads the key filter) ---
+    LoadPlugins();
+
     // --- Install Keyboard Hook ---
-    // PRIVACY NOTICE: This hook monitors ONLY VK_CAPITAL and VK_NUMLOCK.
+    // PRIVACY NOTICE: This hook monitors ONLY VK_CAPITAL, VK_NUMLOCK and keys
+    // registered by installed plugins.
     // It does NOT log keystrokes, capture passwords, or send data anywhere.
     // Required for detecting lock key state changes globally.
     g_keyboardHook = SetWindowsHookEx(WH_KEYBOARD_LL, KeyboardProc, hInstance, 0);
@@ -535,6 +726,9 @@ int WINAPI WinMain(
 
     // --- Cleanup ---
     if (g_keyboardHook) UnhookWindowsHookEx(g_keyboardHook);
+    UnloadPlugins();
+    StopRenderWorker();
+    DestroyRenderSurfaces();
     GdiplusShutdown(g_gdiplusToken);
     if (mutex) { ReleaseMutex(mutex); CloseHandle(mutex); }
 
@@ -562,15 +756,137 @@ void CenterOnActiveMonitor(HWND hwnd)
 }
 
 // =============================================================================
-// Render the OSD
+// Presentation Policy Inputs
 // =============================================================================
 
-void UpdateOSD()
+ForegroundState QueryForegroundState()
 {
-    if (!g_hwndOSD) return;
+    QUERY_USER_NOTIFICATION_STATE quns;
+    if (SUCCEEDED(SHQueryUserNotificationState(&quns))) {
+        switch (quns) {
+        case QUNS_RUNNING_D3D_FULL_SCREEN: return FG_EXCLUSIVE_FULLSCREEN;
+        case QUNS_PRESENTATION_MODE:       return FG_PRESENTATION;
+        case QUNS_BUSY:                    return FG_BORDERLESS_FULLSCREEN;
+        default:                           break;
+        }
+    }
+
+    // Many borderless games don't report QUNS_BUSY - check if the
+    // foreground window covers its whole monitor instead
+    HWND hwndFg = GetForegroundWindow();
+    if (!hwndFg || hwndFg == g_hwndOSD) return FG_NORMAL;
+
+    // The desktop itself is monitor-sized but isn't a game
+    wchar_t className[16];
+    if (GetClassNameW(hwndFg, className, 16) &&
+        (wcscmp(className, L"Progman") == 0 || wcscmp(className, L"WorkerW") == 0)) {
+        return FG_NORMAL;
+    }
+
+    RECT rcWnd;
+    MONITORINFO mi = { sizeof(MONITORINFO) };
+    if (GetWindowRect(hwndFg, &rcWnd) &&
+        GetMonitorInfo(MonitorFromWindow(hwndFg, MONITOR_DEFAULTTONEAREST), &mi) &&
+        EqualRect(&rcWnd, &mi.rcMonitor)) {
+        return FG_BORDERLESS_FULLSCREEN;
+    }
+
+    return FG_NORMAL;
+}
+
+PowerState QueryPowerState()
+{
+    // Efficiency mode (Task Manager) throttles our execution speed
+    PROCESS_POWER_THROTTLING_STATE throttling = {};
+    throttling.Version = PROCESS_POWER_THROTTLING_CURRENT_VERSION;
+    if (GetProcessInformation(GetCurrentProcess(), ProcessPowerThrottling,
+            &throttling, sizeof(throttling)) &&
+        (throttling.ControlMask & throttling.StateMask & PROCESS_POWER_THROTTLING_EXECUTION_SPEED)) {
+        return POWER_SAVER;
+    }
+
+    SYSTEM_POWER_STATUS sps;
+    if (!GetSystemPowerStatus(&sps)) return POWER_AC;
+
+    if (sps.SystemStatusFlag & 1) return POWER_SAVER; // Battery saver is on
+    if (sps.ACLineStatus == 0) return POWER_BATTERY;
+    return POWER_AC;
+}
+
+// =============================================================================
+// Render Surfaces
+// =============================================================================
+
+bool CreateRenderSurfaces()
+{
+    HDC hdcScreen = GetDC(NULL);
+    ScreenDCReleaser screenReleaser{ hdcScreen };
+
+    BITMAPINFO bmi = {};
+    bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    bmi.bmiHeader.biWidth = OSD_WIDTH;
+    bmi.bmiHeader.biHeight = -OSD_HEIGHT; // Top-down, matches GDI+ stride
+    bmi.bmiHeader.biPlanes = 1;
+    bmi.bmiHeader.biBitCount = 32;
+    bmi.bmiHeader.biCompression = BI_RGB;
+
+    for (RenderSurface& surface : g_surfaces) {
+        surface.hdc = CreateCompatibleDC(hdcScreen);
+        if (!surface.hdc) return false;
+
+        // DIB sections start zeroed, i.e. fully transparent
+        surface.hbm = CreateDIBSection(hdcScreen, &bmi, DIB_RGB_COLORS, &surface.bits, NULL, 0);
+        if (!surface.hbm) return false;
+
+        surface.hOld = SelectObject(surface.hdc, surface.hbm);
+    }
+    return true;
+}
+
+void DestroyRenderSurfaces()
+{
+    for (RenderSurface& surface : g_surfaces) {
+        if (surface.hdc && surface.hOld) SelectObject(surface.hdc, surface.hOld);
+        if (surface.hbm) DeleteObject(surface.hbm);
+        if (surface.hdc) DeleteDC(surface.hdc);
+        surface = {};
+    }
+}
 
-    // Create off-screen bitmap
-    Bitmap bmp(OSD_WIDTH, OSD_HEIGHT, PixelFormat32bppARGB);
+// =============================================================================
+// Background Render Worker
+// =============================================================================
+
+bool StartRenderWorker()
+{
+    g_renderThread = CreateThread(NULL, 0, RenderWorkerProc, NULL, 0, &g_renderThreadId);
+    return g_renderThread != NULL;
+}
+
+void StopRenderWorker()
+{
+    if (g_renderThread) {
+        g_renderQueue.Stop();
+        WaitForSingleObject(g_renderThread, INFINITE);
+        CloseHandle(g_renderThread);
+        g_renderThread = NULL;
+    }
+}
+
+// Called from the UI thread whenever g_text changes
+void RequestRender()
+{
+    RenderRequest request;
+    wcscpy_s(request.text, 64, g_text);
+    request.isOn = g_textIsOn;
+    g_renderQueue.Request(request);
+}
+
+// Draws text into a surface's pixel memory. Returns false if superseded mid-render.
+bool RenderContent(const wchar_t* text, bool isOn, void* bits, uint32_t generation)
+{
+    // Wrap the DIB memory directly - no GetHBITMAP copy, already premultiplied
+    Bitmap bmp(OSD_WIDTH, OSD_HEIGHT, OSD_WIDTH * 4, PixelFormat32bppPARGB, static_cast<BYTE*>(bits));
     Graphics graphics(&bmp);
     graphics.SetSmoothingMode(SmoothingModeAntiAlias);
     graphics.SetTextRenderingHint(TextRenderingHintAntiAliasGridFit);
@@ -582,63 +898,90 @@ void UpdateOSD()
     SolidBrush bgBrush(Color(BG_ALPHA, BG_RED, BG_GREEN, BG_BLUE));
     graphics.FillPath(&bgBrush, &bgPath);
 
+    if (g_renderQueue.IsSuperseded(generation)) return false;
+
     // --- Draw Text ---
     Font font(FONT_NAME, FONT_SIZE, FontStyleBold);
     SolidBrush textBrush(Color(255, TEXT_RED, TEXT_GREEN, TEXT_BLUE));
     SolidBrush onBrush(Color(255, ON_RED, ON_GREEN, ON_BLUE));
     SolidBrush offBrush(Color(255, OFF_RED, OFF_GREEN, OFF_BLUE));
 
-    // Find the colon in g_text
-    const wchar_t* colonPtr = wcschr(g_text, L':');
+    // Find the colon in text
+    const wchar_t* colonPtr = wcschr(text, L':');
 
     if (colonPtr != nullptr) {
         // Split into key part and status part
-        wchar_t keyPart[32] = { 0 };
-        wchar_t statusPart[8] = { 0 };
+        wchar_t keyPart[OSD_LABEL_MAX + 1] = { 0 };
+        wchar_t statusPart[OSD_STATUS_MAX] = { 0 };
 
-        size_t keyLen = (size_t)(colonPtr - g_text + 1); // include colon
-        if (keyLen < 32) {
-            wcsncpy_s(keyPart, 32, g_text, keyLen);
+        size_t keyLen = (size_t)(colonPtr - text + 1); // include colon
+        if (keyLen <= OSD_LABEL_MAX) {
+            wcsncpy_s(keyPart, OSD_LABEL_MAX + 1, text, keyLen);
             keyPart[keyLen] = L'\0';
         }
 
         // Status part starts after ": " (colon + space)
         const wchar_t* statusStart = colonPtr + 2;
         if (*statusStart) {
-            wcscpy_s(statusPart, 8, statusStart);
+            wcsncpy_s(statusPart, OSD_STATUS_MAX, statusStart, _TRUNCATE);
         }
 
-        RectF boxKey, boxWidestStatus, boxSpace;
+        // Reserve at least the width of "OFF" so ON/OFF toggles don't wiggle
+        RectF boxKey, boxWidestStatus, boxStatus, boxSpace;
         graphics.MeasureString(keyPart, -1, &font, PointF(0, 0), &boxKey);
         graphics.MeasureString(L"OFF", -1, &font, PointF(0, 0), &boxWidestStatus);
+        graphics.MeasureString(statusPart, -1, &font, PointF(0, 0), &boxStatus);
         graphics.MeasureString(L" ", -1, &font, PointF(0, 0), &boxSpace);
 
         float spaceWidth = boxSpace.Width / 2.0f;
-        float totalStableWidth = boxKey.Width + spaceWidth + boxWidestStatus.Width;
+        float statusWidth = max(boxWidestStatus.Width, boxStatus.Width);
+        float totalStableWidth = boxKey.Width + spaceWidth + statusWidth;
         float startX = (OSD_WIDTH - totalStableWidth) / 2.0f;
         float startY = (OSD_HEIGHT - boxKey.Height) / 2.0f;
 
         graphics.DrawString(keyPart, -1, &font, PointF(startX, startY), &textBrush);
 
-        bool isOn = (wcscmp(statusPart, L"ON") == 0);
         graphics.DrawString(statusPart, -1, &font,
             PointF(startX + boxKey.Width + spaceWidth, startY),
             isOn ? &onBrush : &offBrush);
     }
 
-    // --- Update Layered Window ---
-    HDC hdcScreen = GetDC(NULL);
-    ScreenDCReleaser screenReleaser{ hdcScreen };
+    graphics.Flush(FlushIntentionSync);
+    return true;
+}
 
-    HDC hdcMem = CreateCompatibleDC(hdcScreen);
-    MemoryDCDeleter memDeleter{ hdcMem };
+DWORD WINAPI RenderWorkerProc(LPVOID param)
+{
+    UNREFERENCED_PARAMETER(param);
+
+    RenderQueue<RenderRequest>::Job job;
+    while (g_renderQueue.Claim(job)) {
+        Trace(TRACE_RENDER_BEGIN, job.generation);
+        bool completed = RenderContent(job.content.text, job.content.isOn,
+            g_surfaces[job.surface].bits, job.generation);
+        Trace(TRACE_RENDER_END, completed ? 1 : 0);
+
+        // Superseded frames are simply dropped - the next Claim picks up the newer state
+        if (completed && g_renderQueue.Publish(job)) {
+            PostMessage(g_hwndOSD, WM_RENDER_COMPLETE, 0, 0);
+            Trace(TRACE_POST, WM_RENDER_COMPLETE);
+        }
+    }
+    return 0;
+}
 
-    HBITMAP hBitmap = NULL;
-    bmp.GetHBITMAP(Color(0, 0, 0, 0), &hBitmap);
-    BitmapDeleter bitmapDeleter{ hBitmap };
+// =============================================================================
+// Present the OSD (UI thread - no drawing, just blend the front surface)
+// =============================================================================
 
-    HBITMAP hOldBitmap = (HBITMAP)SelectObject(hdcMem, hBitmap);
-    GdiPlusObjectSelector selector{ hdcMem, hOldBitmap };
+void UpdateOSD()
+{
+    if (!g_hwndOSD) return;
+
+    HDC hdcScreen = GetDC(NULL);
+    ScreenDCReleaser screenReleaser{ hdcScreen };
+
+    HDC hdcMem = g_surfaces[g_renderQueue.Front()].hdc;
 
     SIZE size = { OSD_WIDTH, OSD_HEIGHT };
     POINT ptSrc = { 0, 0 };
@@ -654,31 +997,186 @@ void UpdateOSD()
     blend.SourceConstantAlpha = (BYTE)g_currentAlpha;
     blend.AlphaFormat = AC_SRC_ALPHA;
 
+    Trace(TRACE_PRESENT_BEGIN, g_currentAlpha);
     UpdateLayeredWindow(g_hwndOSD, hdcScreen, &ptDst, &size, hdcMem, &ptSrc, 0, &blend, ULW_ALPHA);
+    Trace(TRACE_PRESENT_END);
+    g_presentStats.CountFrame();
 }
 
 // =============================================================================
-// Show Indicator with Animation
+// Indicator Text
 // =============================================================================
 
-void ShowIndicator()
+void SetIndicatorText(const wchar_t* label, const wchar_t* status, bool isOn)
 {
-    KillTimer(g_hwndOSD, TIMER_STAY);
-    KillTimer(g_hwndOSD, TIMER_ANIM);
+    wchar_t text[64];
+    wcscpy_s(text, 64, label);
+    wcscat_s(text, 64, L": ");
+    wcscat_s(text, 64, status);
+
+    // Same content is already rendered (or being rendered) - nothing to redraw
+    if (isOn == g_textIsOn && wcscmp(text, g_text) == 0) return;
+
+    wcscpy_s(g_text, 64, text);
+    g_textIsOn = isOn;
+
+    RequestRender();
+}
+
+// =============================================================================
+// Plugin Host
+// =============================================================================
 
-    CenterOnActiveMonitor(g_hwndOSD);
+int OSD_CALL HostRegisterIndicator(const OsdIndicatorDesc* desc)
+{
+    return g_pluginsLoading ? g_plugins.Register(desc) : -1;
+}
 
-    if (g_animState == STATE_HIDDEN || g_animState == STATE_FADING_OUT) {
-        g_animState = STATE_FADING_IN;
-        SetTimer(g_hwndOSD, TIMER_ANIM, ANIM_INTERVAL, NULL);
-        ShowWindow(g_hwndOSD, SW_SHOWNOACTIVATE);
+void OSD_CALL HostNotify(int indicatorId)
+{
+    // May be called from any thread - hand off to the UI thread
+    if (g_plugins.IsValid(indicatorId)) {
+        PostMessage(g_hwndOSD, WM_PLUGIN_EVENT, static_cast<WPARAM>(indicatorId), 0);
+        Trace(TRACE_POST, WM_PLUGIN_EVENT);
     }
-    else if (g_animState == STATE_VISIBLE || g_animState == STATE_FADING_IN) {
-        // Already visible - just reset the stay timer
-        g_currentAlpha = 255;
-        g_animState = STATE_VISIBLE;
-        UpdateOSD();
-        SetTimer(g_hwndOSD, TIMER_STAY, DISPLAY_TIME, NULL);
+}
+
+const OsdHostApi g_hostApi = { OSD_PLUGIN_API_VERSION, HostRegisterIndicator, HostNotify };
+
+void LoadPlugins()
+{
+    // Built-in keys share the same filter as plugin keys
+    g_plugins.AddKey(VK_CAPITAL);
+    g_plugins.AddKey(VK_NUMLOCK);
+
+    wchar_t pluginDir[MAX_PATH];
+    DWORD len = GetModuleFileNameW(NULL, pluginDir, MAX_PATH);
+    if (len == 0 || len >= MAX_PATH) return;
+
+    wchar_t* lastSlash = wcsrchr(pluginDir, L'\\');
+    if (!lastSlash) return;
+    lastSlash[1] = L'\0';
+    if (wcscat_s(pluginDir, MAX_PATH, L"plugins\\") != 0) return;
+
+    wchar_t pattern[MAX_PATH];
+    wcscpy_s(pattern, MAX_PATH, pluginDir);
+    if (wcscat_s(pattern, MAX_PATH, L"*.dll") != 0) return;
+
+    WIN32_FIND_DATAW fd;
+    HANDLE hFind = FindFirstFileW(pattern, &fd);
+    if (hFind == INVALID_HANDLE_VALUE) return;
+
+    g_pluginsLoading = true;
+    do {
+        if (g_pluginModuleCount >= OSD_MAX_INDICATORS || g_plugins.Count() >= OSD_MAX_INDICATORS) break;
+        if (fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) continue;
+
+        wchar_t path[MAX_PATH];
+        wcscpy_s(path, MAX_PATH, pluginDir);
+        if (wcscat_s(path, MAX_PATH, fd.cFileName) != 0) continue;
+
+        // Resolve plugin dependencies from its own folder, never the current directory
+        HMODULE hModule = LoadLibraryExW(path, NULL,
+            LOAD_LIBRARY_SEARCH_DLL_LOAD_DIR | LOAD_LIBRARY_SEARCH_DEFAULT_DIRS);
+        if (!hModule) continue;
+
+        // A plugin may register indicators and still fail its init - drop
+        // them so nothing calls into the DLL after it is freed
+        int registered = g_plugins.Count();
+        auto init = reinterpret_cast<OsdPluginInitFn>(GetProcAddress(hModule, OSD_PLUGIN_INIT_EXPORT));
+        if (init && init(&g_hostApi)) {
+            g_pluginModules[g_pluginModuleCount++] = hModule;
+        }
+        else {
+            g_plugins.Truncate(registered);
+            FreeLibrary(hModule);
+        }
+    } while (FindNextFileW(hFind, &fd));
+    g_pluginsLoading = false;
+
+    FindClose(hFind);
+}
+
+void UnloadPlugins()
+{
+    g_plugins.Clear();
+    for (int i = g_pluginModuleCount - 1; i >= 0; i--) {
+        auto shutdown = reinterpret_cast<OsdPluginShutdownFn>(
+            GetProcAddress(g_pluginModules[i], OSD_PLUGIN_SHUTDOWN_EXPORT));
+        if (shutdown) shutdown();
+        FreeLibrary(g_pluginModules[i]);
+    }
+    g_pluginModuleCount = 0;
+}
+
+// Returns true if a plugin claimed this key press and updated the OSD
+bool DispatchPluginKey(UINT vkCode)
+{
+    OsdIndicatorState state;
+    if (!g_plugins.DispatchKey(vkCode, state)) return false;
+
+    SetIndicatorText(state.label, state.status, state.isOn != 0);
+    ShowIndicator();
+    return true;
+}
+
+// =============================================================================
+// Animation State Machine Dispatch
+// =============================================================================
+
+void SetAnimState(AnimationState state)
+{
+    if (g_animState != state) {
+        g_animState = state;
+        Trace(TRACE_STATE, state);
+    }
+}
+
+// Looks up (g_animState, event) and runs its actions as one batch, in a fixed
+// order: stop timers, move, change alpha, present, show/hide, start timers.
+void DispatchAnimEvent(AnimEvent event, int stepAlpha)
+{
+    AnimTransition t = Step(g_animState, event);
+    if (!t.legal) return; // e.g. a tick already queued before KillTimer - ignore it
+
+    UINT a = t.actions;
+
+    if (a & ACT_KILL_ANIM) KillTimer(g_hwndOSD, TIMER_ANIM);
+    if (a & ACT_KILL_STAY) KillTimer(g_hwndOSD, TIMER_STAY);
+    if (a & ACT_POSITION) CenterOnActiveMonitor(g_hwndOSD);
+
+    if (a & ACT_SET_ALPHA) g_currentAlpha = stepAlpha;
+    if (a & ACT_OPAQUE) g_currentAlpha = 255;
+    if (a & ACT_TRANSPARENT) g_currentAlpha = 0;
+    if (a & ACT_PRESENT) UpdateOSD();
+
+    if (a & ACT_SHOW_WINDOW) ShowWindow(g_hwndOSD, SW_SHOWNOACTIVATE);
+    if (a & ACT_HIDE_WINDOW) ShowWindow(g_hwndOSD, SW_HIDE);
+
+    if (a & (ACT_START_ANIM | ACT_RESTART_ANIM)) SetTimer(g_hwndOSD, TIMER_ANIM, CurrentAnimInterval(), NULL);
+    if (a & (ACT_START_STAY | ACT_RESTART_STAY)) SetTimer(g_hwndOSD, TIMER_STAY, DISPLAY_TIME, NULL);
+
+    SetAnimState(t.next);
+}
+
+// =============================================================================
+// Show Indicator with Animation
+// =============================================================================
+
+void ShowIndicator()
+{
+    g_presentMode = EvaluatePresentPolicy(QueryForegroundState(), QueryPowerState(), GAME_AWARE_PRESENTATION);
+    Trace(TRACE_SHOW, g_presentMode);
+    g_presentStats.BeginShow(g_presentMode);
+
+    // Text still being rendered is held back until WM_RENDER_COMPLETE
+    // instead of flashing the previous indicator
+    bool pending = g_renderQueue.IsContentPending();
+
+    switch (g_presentMode) {
+    case PRESENT_SUPPRESSED: DispatchAnimEvent(EV_SUPPRESS); break; // Stay off screen over exclusive fullscreen
+    case PRESENT_INSTANT:    DispatchAnimEvent(pending ? EV_SHOW_INSTANT_PENDING : EV_SHOW_INSTANT); break;
+    default:                 DispatchAnimEvent(pending ? EV_SHOW_PENDING : EV_SHOW); break;
     }
 }
 
@@ -688,49 +1186,65 @@ void ShowIndicator()
 
 LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
 {
+    if (msg >= WM_KEYSTATE_CHANGED && msg <= WM_DUMP_TRACE) {
+        Trace(TRACE_DISPATCH, msg);
+    }
+
     switch (msg) {
 
     case WM_KEYSTATE_CHANGED:
     {
         UINT vkCode = static_cast<UINT>(wParam);
-        const wchar_t* keyName = (vkCode == VK_CAPITAL) ? L"CapsLock" : L"NumLock";
-        bool isOn = (GetKeyState(vkCode) & 0x0001) != 0;
 
-        // Build text: "CapsLock: ON" or "NumLock: OFF" etc.
-        wcscpy_s(g_text, 64, keyName);
-        wcscat_s(g_text, 64, L": ");
-        wcscat_s(g_text, 64, isOn ? L"ON" : L"OFF");
+        // Plugins watching this key get first say, in registration order
+        if (DispatchPluginKey(vkCode)) {
+            return 0;
+        }
+
+        if (vkCode == VK_CAPITAL || vkCode == VK_NUMLOCK) {
+            const wchar_t* keyName = (vkCode == VK_CAPITAL) ? L"CapsLock" : L"NumLock";
+            bool isOn = (GetKeyState(vkCode) & 0x0001) != 0;
+
+            // Text: "CapsLock: ON" or "NumLock: OFF" etc.
+            SetIndicatorText(keyName, isOn ? L"ON" : L"OFF", isOn);
+            ShowIndicator();
+        }
+        return 0;
+    }
+
+    case WM_PLUGIN_EVENT:
+    {
+        OsdIndicatorState state;
+        if (g_plugins.GetEventState(static_cast<int>(wParam), state)) {
+            SetIndicatorText(state.label, state.status, state.isOn != 0);
+            ShowIndicator();
+        }
+        return 0;
+    }
 
-        ShowIndicator();
+    case WM_RENDER_COMPLETE:
+        if (g_renderQueue.Swap()) {
+            DispatchAnimEvent(EV_CONTENT_READY);
+        }
         return 0;
+
+    case WM_DUMP_TRACE:
+    {
+        // Requested by "OsdLockIndicator.exe /dumptrace"
+        wchar_t tracePath[MAX_PATH];
+        return (GetTracePath(tracePath, MAX_PATH) && DumpTrace(tracePath)) ? 1 : 0;
     }
 
     case WM_TIMER:
+        Trace(TRACE_TIMER, static_cast<DWORD>(wParam));
         if (wParam == TIMER_ANIM) {
-            if (g_animState == STATE_FADING_IN) {
-                g_currentAlpha = CalculateNextAlpha(g_currentAlpha, 255, true);
-                if (g_currentAlpha >= 255) {
-                    g_currentAlpha = 255;
-                    g_animState = STATE_VISIBLE;
-                    KillTimer(hwnd, TIMER_ANIM);
-                    SetTimer(hwnd, TIMER_STAY, DISPLAY_TIME, NULL);
-                }
-            }
-            else if (g_animState == STATE_FADING_OUT) {
-                g_currentAlpha = CalculateNextAlpha(g_currentAlpha, 0, false);
-                if (g_currentAlpha <= 0) {
-                    g_currentAlpha = 0;
-                    g_animState = STATE_HIDDEN;
-                    KillTimer(hwnd, TIMER_ANIM);
-                    ShowWindow(hwnd, SW_HIDE);
-                }
-            }
-            UpdateOSD();
+            bool fadeIn = FadesIn(g_animState);
+            int target = fadeIn ? 255 : 0;
+            int nextAlpha = CalculateNextAlpha(g_currentAlpha, target, fadeIn);
+            DispatchAnimEvent((nextAlpha == target) ? EV_FADE_DONE : EV_FADE_STEP, nextAlpha);
         }
         else if (wParam == TIMER_STAY) {
-            KillTimer(hwnd, TIMER_STAY);
-            g_animState = STATE_FADING_OUT;
-            SetTimer(hwnd, TIMER_ANIM, ANIM_INTERVAL, NULL);
+            DispatchAnimEvent((g_presentMode == PRESENT_INSTANT) ? EV_HIDE_NOW : EV_STAY_EXPIRED);
         }
         return 0;
 
@@ -745,13 +1259,15 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
 // =============================================================================
 // KEYBOARD HOOK - PRIVACY & SECURITY NOTICE
 // =============================================================================
-// This hook monitors ONLY Caps Lock (VK_CAPITAL) and Num Lock (VK_NUMLOCK).
+// This hook monitors ONLY Caps Lock (VK_CAPITAL), Num Lock (VK_NUMLOCK) and
+// keys registered by plugins you installed in the "plugins" folder.
 // 
 // It does NOT:
-//   ❌ Log any keystrokes beyond these two keys
+//   ❌ Log any keystrokes beyond these keys
 //   ❌ Capture passwords or sensitive data
 //   ❌ Send any data over the network
-//   ❌ Store any information to disk
+//   ❌ Store any information to disk (a /dumptrace export holds only
+//      timings and state numbers, never key codes)
 //   ❌ Monitor typing in any application
 // 
 // Purpose: Detect when user presses Caps/Num Lock to show visual indicator
@@ -763,11 +1279,16 @@ LRESULT CALLBACK KeyboardProc(int nCode, WPARAM wParam, LPARAM lParam)
 {
     if (nCode >= 0 && wParam == WM_KEYUP) {
         KBDLLHOOKSTRUCT* pKey = (KBDLLHOOKSTRUCT*)lParam;
+        DWORD vkCode = pKey->vkCode;
+
+        // One bitmap lookup covers Caps Lock, Num Lock and all plugin keys -
+        // every other key is ignored
+        if (g_plugins.Accepts(vkCode)) {
+            Trace(TRACE_HOOK);
 
-        // Only process Caps Lock and Num Lock - ignore all other keys
-        if (pKey->vkCode == VK_CAPITAL || pKey->vkCode == VK_NUMLOCK) {
             // Post message to handle in the main thread
             PostMessage(g_hwndOSD, WM_KEYSTATE_CHANGED, pKey->vkCode, 0);
+            Trace(TRACE_POST, WM_KEYSTATE_CHANGED);
         }
     }
     return CallNextHookEx(g_keyboardHook, nCode, wParam, lParam);
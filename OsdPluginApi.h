@@ -0,0 +1,86 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  OSD LOCK INDICATOR - Plugin API
+//
+//  PURPOSE:
+//    Lets other small indicators (mic mute, keyboard layout, volume keys...)
+//    reuse this app's single keyboard hook, renderer, animation and placement
+//    instead of installing their own hook and OSD window.
+//
+//  HOW PLUGINS ARE LOADED:
+//    Any DLL in a "plugins" folder next to OsdLockIndicator.exe is loaded at
+//    startup. It must export OsdPluginInit, and may export OsdPluginShutdown.
+//    Inside OsdPluginInit the plugin calls host->registerIndicator once per
+//    indicator it wants to provide.
+//
+//  THREADING:
+//    filter and getState are always called on the host UI thread.
+//    notify may be called from any thread.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <stdint.h>
+#include <wchar.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define OSD_PLUGIN_API_VERSION  1
+#define OSD_MAX_INDICATORS      32      // Across all plugins
+#define OSD_LABEL_MAX           32      // Including terminator
+#define OSD_STATUS_MAX          16      // Including terminator
+
+// Calling convention of every function crossing the plugin boundary
+#ifdef _WIN32
+#define OSD_CALL __cdecl
+#else
+#define OSD_CALL
+#endif
+
+#define OSD_PLUGIN_INIT_EXPORT      "OsdPluginInit"
+#define OSD_PLUGIN_SHUTDOWN_EXPORT  "OsdPluginShutdown"
+
+// What the OSD displays, e.g. label L"Mic", status L"MUTED", isOn 0
+typedef struct OsdIndicatorState {
+    wchar_t label[OSD_LABEL_MAX];
+    wchar_t status[OSD_STATUS_MAX];
+    int isOn;                           // Nonzero = ON color, zero = OFF color
+} OsdIndicatorState;
+
+// Called when one of the indicator's keys is released.
+// Return nonzero to show the indicator, zero to ignore this key press.
+typedef int (OSD_CALL *OsdKeyFilterFn)(void* context, uint32_t vkCode);
+
+// Fills in what to display. vkCode is 0 when triggered through notify.
+// Return nonzero to show, zero to skip.
+typedef int (OSD_CALL *OsdStateProviderFn)(void* context, uint32_t vkCode, OsdIndicatorState* state);
+
+typedef struct OsdIndicatorDesc {
+    uint32_t structSize;                // sizeof(OsdIndicatorDesc)
+    const uint32_t* vkCodes;            // Keys to watch (0-255), NULL if vkCount is 0
+    uint32_t vkCount;
+    OsdKeyFilterFn filter;              // Optional - NULL accepts every watched key
+    OsdStateProviderFn getState;        // Required
+    void* context;                      // Passed back to filter and getState
+} OsdIndicatorDesc;
+
+typedef struct OsdHostApi {
+    uint32_t version;                   // OSD_PLUGIN_API_VERSION of the host
+
+    // Only valid inside OsdPluginInit. Returns an indicator id, or -1 on failure.
+    int (OSD_CALL *registerIndicator)(const OsdIndicatorDesc* desc);
+
+    // Shows the indicator for a non-key event (e.g. mute toggled from a headset).
+    void (OSD_CALL *notify)(int indicatorId);
+} OsdHostApi;
+
+// Plugin exports. OsdPluginInit returns nonzero to stay loaded.
+typedef int (OSD_CALL *OsdPluginInitFn)(const OsdHostApi* host);
+typedef void (OSD_CALL *OsdPluginShutdownFn)(void);
+
+#ifdef __cplusplus
+}
+#endif
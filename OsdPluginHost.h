@@ -0,0 +1,153 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  OSD LOCK INDICATOR - Plugin Registry & Key Filter
+//
+//  PURPOSE:
+//    The host side of OsdPluginApi.h that doesn't touch Win32: validating
+//    registrations, the key filter KeyboardProc checks on every keystroke,
+//    and routing a key to the plugin indicator that claims it. Loading the
+//    DLLs stays in OsdLockIndicator.cpp. Benchmarked on Linux in
+//    tests/PluginHostBench.cpp.
+//
+//  KEY FILTER:
+//    One 256-bit bitmap covers the built-in lock keys and every plugin key,
+//    so the hook does a single lookup per keystroke no matter how many
+//    plugins are loaded. Per-key masks (bit N = indicator N watches it) keep
+//    dispatch from scanning indicators that don't care about the key.
+//    Everything is written while plugins load (before the hook is installed)
+//    and read-only afterwards.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "OsdPluginApi.h"
+
+#include <cstdint>
+
+static_assert(OSD_MAX_INDICATORS <= 32, "Per-key indicator masks are 32 bits wide");
+
+class PluginRegistry {
+public:
+    // Forwards a key to the UI thread without binding it to an indicator (Caps/Num Lock)
+    void AddKey(uint32_t vkCode)
+    {
+        if (vkCode >= 256) return;
+        m_builtinKeys[vkCode >> 5] |= 1u << (vkCode & 31);
+        m_vkFilter[vkCode >> 5] |= 1u << (vkCode & 31);
+    }
+
+    // The per-keystroke check in KeyboardProc
+    bool Accepts(uint32_t vkCode) const
+    {
+        return vkCode < 256 && (m_vkFilter[vkCode >> 5] & (1u << (vkCode & 31))) != 0;
+    }
+
+    // Returns an indicator id, or -1 if the descriptor is invalid or the table is full
+    int Register(const OsdIndicatorDesc* desc)
+    {
+        if (!desc || desc->structSize < sizeof(OsdIndicatorDesc) || !desc->getState ||
+            (!desc->vkCodes && desc->vkCount) || m_count >= OSD_MAX_INDICATORS) {
+            return -1;
+        }
+        for (uint32_t i = 0; i < desc->vkCount; i++) {
+            if (desc->vkCodes[i] >= 256) return -1;
+        }
+
+        int id = m_count++;
+        m_indicators[id] = { desc->filter, desc->getState, desc->context };
+
+        for (uint32_t i = 0; i < desc->vkCount; i++) {
+            uint32_t vkCode = desc->vkCodes[i];
+            m_vkIndicators[vkCode] |= 1u << id;
+            m_vkFilter[vkCode >> 5] |= 1u << (vkCode & 31);
+        }
+        return id;
+    }
+
+    // Drops every indicator from id count onwards - used when a plugin
+    // registers and then fails its init, before its DLL is unloaded. Keys no
+    // remaining indicator watches leave the filter unless they are built in.
+    void Truncate(int count)
+    {
+        if (count < 0 || count >= m_count) return;
+
+        uint32_t keep = (count > 0) ? ~0u >> (32 - count) : 0;
+        for (int id = count; id < m_count; id++) m_indicators[id] = {};
+        m_count = count;
+
+        for (uint32_t vkCode = 0; vkCode < 256; vkCode++) {
+            m_vkIndicators[vkCode] &= keep;
+        }
+        for (uint32_t word = 0; word < 256 / 32; word++) {
+            uint32_t bits = m_builtinKeys[word];
+            for (uint32_t bit = 0; bit < 32; bit++) {
+                if (m_vkIndicators[word * 32 + bit]) bits |= 1u << bit;
+            }
+            m_vkFilter[word] = bits;
+        }
+    }
+
+    // Asks the indicators watching vkCode, in registration order, until one
+    // claims it. Returns false if none did.
+    bool DispatchKey(uint32_t vkCode, OsdIndicatorState& state) const
+    {
+        uint32_t mask = (vkCode < 256) ? m_vkIndicators[vkCode] : 0;
+
+        for (int id = 0; mask != 0; id++, mask >>= 1) {
+            if (!(mask & 1)) continue;
+
+            const Indicator& indicator = m_indicators[id];
+            if (indicator.filter && !indicator.filter(indicator.context, vkCode)) continue;
+
+            state = {};
+            if (indicator.getState(indicator.context, vkCode, &state)) {
+                Terminate(state);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // State for a notify() from the plugin (vkCode 0)
+    bool GetEventState(int id, OsdIndicatorState& state) const
+    {
+        if (!IsValid(id)) return false;
+
+        state = {};
+        if (!m_indicators[id].getState(m_indicators[id].context, 0, &state)) return false;
+        Terminate(state);
+        return true;
+    }
+
+    bool IsValid(int id) const { return id >= 0 && id < m_count; }
+    int Count() const { return m_count; }
+
+    // Drops every indicator before their DLLs are unloaded. The key filter
+    // is left as is - it only matters while the hook is installed.
+    void Clear()
+    {
+        for (uint32_t& mask : m_vkIndicators) mask = 0;
+        m_count = 0;
+    }
+
+private:
+    struct Indicator {
+        OsdKeyFilterFn filter;
+        OsdStateProviderFn getState;
+        void* context;
+    };
+
+    // Plugins may fill the whole buffer without a terminator
+    static void Terminate(OsdIndicatorState& state)
+    {
+        state.label[OSD_LABEL_MAX - 1] = L'\0';
+        state.status[OSD_STATUS_MAX - 1] = L'\0';
+    }
+
+    Indicator m_indicators[OSD_MAX_INDICATORS] = {};
+    int m_count = 0;
+    uint32_t m_vkFilter[256 / 32] = {};
+    uint32_t m_builtinKeys[256 / 32] = {};      // AddKey() only
+    uint32_t m_vkIndicators[256] = {};
+};
@@ -0,0 +1,90 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  OSD LOCK INDICATOR - Presentation Policy
+//
+//  PURPOSE:
+//    A topmost layered window animating at 100 Hz over a fullscreen game can
+//    force extra DWM composition passes. This table picks how to present
+//    based on what the foreground app is doing and the power state. Plain
+//    C++ with no Win32, so every cell is tested on Linux
+//    (tests/PresentPolicyTests.cpp). The Win32 queries that fill in the
+//    inputs live in OsdLockIndicator.cpp.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstdint>
+
+enum ForegroundState {
+    FG_NORMAL,                  // Regular desktop use
+    FG_BORDERLESS_FULLSCREEN,   // Fullscreen window, still composed by DWM
+    FG_EXCLUSIVE_FULLSCREEN,    // Direct3D exclusive fullscreen
+    FG_PRESENTATION,            // Windows presentation mode
+    FG_STATE_COUNT
+};
+
+enum PowerState {
+    POWER_AC,                   // Plugged in
+    POWER_BATTERY,              // Running on battery
+    POWER_SAVER,                // Battery saver on, or process in efficiency mode
+    POWER_STATE_COUNT
+};
+
+enum PresentMode {
+    PRESENT_FULL,               // Fades at ANIM_INTERVAL
+    PRESENT_REDUCED,            // Fades at REDUCED_ANIM_INTERVAL
+    PRESENT_INSTANT,            // Show/hide with no fades
+    PRESENT_SUPPRESSED,         // Don't show at all
+    PRESENT_MODE_COUNT
+};
+
+constexpr PresentMode PRESENT_POLICY[FG_STATE_COUNT][POWER_STATE_COUNT] = {
+    //                           AC                  Battery             Saver
+    /* FG_NORMAL             */ { PRESENT_FULL,       PRESENT_REDUCED,    PRESENT_REDUCED    },
+    /* FG_BORDERLESS_FULLSCR */ { PRESENT_REDUCED,    PRESENT_INSTANT,    PRESENT_INSTANT    },
+    /* FG_EXCLUSIVE_FULLSCR  */ { PRESENT_SUPPRESSED, PRESENT_SUPPRESSED, PRESENT_SUPPRESSED },
+    /* FG_PRESENTATION       */ { PRESENT_INSTANT,    PRESENT_INSTANT,    PRESENT_INSTANT    },
+};
+
+// gameAware = false (GAME_AWARE_PRESENTATION) keeps the full animation everywhere
+constexpr PresentMode EvaluatePresentPolicy(ForegroundState foreground, PowerState power, bool gameAware)
+{
+    return gameAware ? PRESENT_POLICY[foreground][power] : PRESENT_FULL;
+}
+
+constexpr const char* PresentModeName(PresentMode mode)
+{
+    switch (mode) {
+    case PRESENT_FULL:       return "full";
+    case PRESENT_REDUCED:    return "reduced";
+    case PRESENT_INSTANT:    return "instant";
+    case PRESENT_SUPPRESSED: return "suppressed";
+    default:                 return "unknown";
+    }
+}
+
+// UpdateLayeredWindow calls per presentation mode, exported with /dumptrace.
+// Frames are counted under the mode the indicator was last shown with: a
+// suppressed show never puts anything on screen, and the transparent present
+// it makes to hide a visible indicator belongs to the show it cuts short.
+// frames[PRESENT_SUPPRESSED] therefore stays 0.
+struct PresentStats {
+    uint64_t frames[PRESENT_MODE_COUNT] = {};
+    PresentMode shownMode = PRESENT_FULL;
+
+    // Called for every ShowIndicator with the mode the policy picked
+    void BeginShow(PresentMode mode)
+    {
+        if (mode != PRESENT_SUPPRESSED) shownMode = mode;
+    }
+
+    void CountFrame() { frames[shownMode]++; }
+
+    uint64_t Total() const
+    {
+        uint64_t total = 0;
+        for (uint64_t count : frames) total += count;
+        return total;
+    }
+};
@@ -0,0 +1,133 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  OSD LOCK INDICATOR - Render Queue
+//
+//  PURPOSE:
+//    The hand-off between the UI thread and the background render worker:
+//    which of the two surfaces is on screen, which one the worker may draw
+//    into, and whether a finished frame is still current. Plain C++ with no
+//    Win32, so the protocol is tested on Linux (tests/RenderQueueTests.cpp).
+//
+//  RULES:
+//    - The front surface is only changed by the UI thread, in Swap().
+//    - The worker only draws into the surface Claim() hands it (never front).
+//    - A newer Request() supersedes the render in flight and any finished
+//      frame the UI thread has not swapped in yet.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+template <typename Content>
+class RenderQueue {
+public:
+    struct Job {
+        Content content;
+        uint32_t generation;
+        int surface;                    // Back surface the worker may draw into
+    };
+
+    // --- UI thread ---
+
+    // Queues new content and wakes the worker. Returns its generation.
+    uint32_t Request(const Content& content)
+    {
+        uint32_t generation;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            generation = ++m_requested;
+            m_pending = content;
+        }
+        m_wake.notify_one();
+        return generation;
+    }
+
+    // Promotes the finished frame to front. Returns false if nothing was
+    // ready, or if the frame was superseded before the UI thread got to it.
+    bool Swap()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_ready < 0) return false;
+
+        if (m_readyGeneration != m_requested) {
+            m_ready = -1;               // Stale - a newer render is on its way
+            return false;
+        }
+        m_front = m_ready;
+        m_frontGeneration = m_readyGeneration;
+        m_ready = -1;
+        return true;
+    }
+
+    // Only the UI thread writes m_front, so it can read it without the lock
+    int Front() const { return m_front; }
+
+    // True until the newest requested content has been swapped in
+    bool IsContentPending() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_frontGeneration != m_requested;
+    }
+
+    void Stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+    }
+
+    // --- Worker thread ---
+
+    // Blocks until there is content newer than the last claim. Returns false on Stop().
+    bool Claim(Job& job)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_wake.wait(lock, [this] { return m_stop || m_requested != m_claimed; });
+        if (m_stop) return false;
+
+        job.content = m_pending;
+        job.generation = m_requested;
+        job.surface = 1 - m_front;
+        m_claimed = m_requested;
+        m_ready = -1;                   // Reclaim a frame the UI never swapped in
+        return true;
+    }
+
+    // Polled between drawing stages so stale renders stop early
+    bool IsSuperseded(uint32_t generation) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stop || m_requested != generation;
+    }
+
+    // Offers a finished frame to the UI thread. Returns true if the caller
+    // should notify it; false if the frame is already stale.
+    bool Publish(const Job& job)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_stop || m_requested != job.generation) return false;
+
+        m_ready = job.surface;
+        m_readyGeneration = job.generation;
+        return true;
+    }
+
+private:
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+
+    Content m_pending{};
+    uint32_t m_requested = 0;           // Newest generation asked for
+    uint32_t m_claimed = 0;             // Newest generation handed to the worker
+    uint32_t m_readyGeneration = 0;
+    uint32_t m_frontGeneration = 0;
+    int m_front = 0;
+    int m_ready = -1;                   // Finished surface awaiting Swap(), or -1
+    bool m_stop = false;
+};
@@ -0,0 +1,208 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  OSD LOCK INDICATOR - Lifecycle Trace (always on, fixed-size ring)
+//
+//  PURPOSE:
+//    Every step from hook to pixels is stamped into a lock-free ring so a
+//    slow indicator can be explained, not just measured. "/dumptrace" asks
+//    the running instance to export the ring as Chrome/Perfetto trace JSON.
+//    Only timings and state numbers are recorded - never key codes.
+//
+//  PLATFORM:
+//    The ring takes its clock and thread ids from a Platform type with
+//        static int64_t Now();         // Timestamp in ticks
+//        static int64_t Frequency();   // Ticks per second
+//        static uint32_t ThreadId();
+//    OsdLockIndicator.cpp plugs in QueryPerformanceCounter and
+//    GetCurrentThreadId; tests/TraceTests.cpp uses a fake and a steady_clock.
+//
+//  COST:
+//    Record() is one Platform::Now(), one Platform::ThreadId(), one atomic
+//    increment and one compare-exchange to claim the slot. The slot is then
+//    published seqlock-style with plain stores and a release fence, so the
+//    exporter can skip slots that are being overwritten without writers ever
+//    waiting on it. A writer that finds its slot still held by a stalled
+//    writer a full lap behind drops its record instead of waiting (Dropped()).
+//    Indices are 64-bit so the ring never wraps its numbering while running.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+enum TraceEvent : uint16_t {
+    TRACE_HOOK,             // KeyboardProc accepted a key
+    TRACE_POST,             // Message posted to the UI thread
+    TRACE_DISPATCH,         // WndProc received one of our messages (arg = msg)
+    TRACE_SHOW,             // ShowIndicator (arg = PresentMode)
+    TRACE_RENDER_BEGIN,     // Worker started drawing (arg = generation)
+    TRACE_RENDER_END,       // Worker finished (arg = 1 completed, 0 superseded)
+    TRACE_PRESENT_BEGIN,    // UpdateLayeredWindow call (arg = alpha)
+    TRACE_PRESENT_END,
+    TRACE_TIMER,            // WM_TIMER fired (arg = timer id)
+    TRACE_STATE,            // g_animState changed (arg = new AnimationState)
+    TRACE_EVENT_COUNT
+};
+
+struct TraceRecord {
+    TraceEvent event;
+    uint32_t threadId;
+    uint32_t arg;
+    int64_t timestamp;      // Platform ticks
+};
+
+// Names a thread in the exported timeline
+struct TraceThreadName {
+    uint32_t threadId;
+    const char* name;
+};
+
+template <typename Platform, uint32_t Capacity>
+class TraceRing {
+    static_assert(Capacity != 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    // Timestamp that maps to ts=0 in the export
+    void SetBase(int64_t ticks) { m_base = ticks; }
+
+    void Record(TraceEvent event, uint32_t arg = 0)
+    {
+        int64_t now = Platform::Now();
+        uint32_t threadId = Platform::ThreadId();
+
+        uint64_t index = m_next.fetch_add(1, std::memory_order_relaxed);
+        Slot& slot = m_slots[index & (Capacity - 1)];
+
+        // Claim the slot unless another writer is still in it or has already
+        // stored a newer record there
+        uint64_t sequence = slot.sequence.load(std::memory_order_relaxed);
+        if ((sequence & 1) || sequence > Complete(index) - 2 ||
+            !slot.sequence.compare_exchange_strong(sequence, Complete(index) - 1, std::memory_order_relaxed)) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.event.store(event, std::memory_order_relaxed);
+        slot.threadId.store(threadId, std::memory_order_relaxed);
+        slot.arg.store(arg, std::memory_order_relaxed);
+        slot.timestamp.store(now, std::memory_order_relaxed);
+        slot.sequence.store(Complete(index), std::memory_order_release);
+    }
+
+    // Records lost to a writer stalled in the same slot, since startup
+    uint64_t Dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    // Index of the next record. Tests use it to start near 32-bit limits.
+    void SkipTo(uint64_t index) { m_next.store(index, std::memory_order_relaxed); }
+
+    // Calls fn(const TraceRecord&) for each complete record still in the
+    // ring, oldest first. Slots rewritten during the copy are skipped.
+    template <typename Fn>
+    void ForEach(Fn&& fn) const
+    {
+        uint64_t end = m_next.load(std::memory_order_acquire);
+        uint64_t start = (end > Capacity) ? end - Capacity : 0;
+
+        for (uint64_t i = start; i != end; i++) {
+            const Slot& slot = m_slots[i & (Capacity - 1)];
+
+            if (slot.sequence.load(std::memory_order_acquire) != Complete(i)) continue;
+            TraceRecord record;
+            record.event = slot.event.load(std::memory_order_relaxed);
+            record.threadId = slot.threadId.load(std::memory_order_relaxed);
+            record.arg = slot.arg.load(std::memory_order_relaxed);
+            record.timestamp = slot.timestamp.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) != Complete(i)) continue;
+
+            fn(record);
+        }
+    }
+
+    // Chrome/Perfetto trace JSON. otherData is the body of the "otherData"
+    // object (e.g. "\"frames\":12"), or nullptr.
+    std::string ExportJson(const TraceThreadName* threads, int threadCount, const char* otherData) const
+    {
+        const uint64_t frequency = static_cast<uint64_t>(Platform::Frequency());
+        std::string json;
+        char line[256];
+
+        json += "{\"displayTimeUnit\":\"ms\",\"otherData\":{";
+        if (otherData) json += otherData;
+        json += "},\"traceEvents\":[";
+
+        bool first = true;
+        for (int i = 0; i < threadCount; i++) {
+            std::snprintf(line, sizeof(line),
+                "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%lu,\"args\":{\"name\":\"%s\"}}",
+                first ? "" : ",", static_cast<unsigned long>(threads[i].threadId), threads[i].name);
+            json += line;
+            first = false;
+        }
+
+        ForEach([&](const TraceRecord& record) {
+            const char* name;
+            const char* phase = "i";
+            const char* argName = nullptr;
+
+            switch (record.event) {
+            case TRACE_HOOK:            name = "KeyboardProc";          break;
+            case TRACE_POST:            name = "PostMessage";           argName = "msg";        break;
+            case TRACE_DISPATCH:        name = "WndProc";               argName = "msg";        break;
+            case TRACE_SHOW:            name = "ShowIndicator";         argName = "mode";       break;
+            case TRACE_RENDER_BEGIN:    name = "Render"; phase = "B";   argName = "generation"; break;
+            case TRACE_RENDER_END:      name = "Render"; phase = "E";   argName = "completed";  break;
+            case TRACE_PRESENT_BEGIN:   name = "UpdateLayeredWindow"; phase = "B"; argName = "alpha"; break;
+            case TRACE_PRESENT_END:     name = "UpdateLayeredWindow"; phase = "E"; break;
+            case TRACE_TIMER:           name = "WM_TIMER";              argName = "id";         break;
+            case TRACE_STATE:           name = "animState"; phase = "C"; argName = "state";     break;
+            default:                    return;
+            }
+
+            // Microseconds with ns precision
+            uint64_t delta = (record.timestamp > m_base) ? static_cast<uint64_t>(record.timestamp - m_base) : 0;
+            uint64_t ns = (delta / frequency) * 1000000000ULL +
+                (delta % frequency) * 1000000000ULL / frequency;
+
+            int len = std::snprintf(line, sizeof(line),
+                "%s\n{\"name\":\"%s\",\"ph\":\"%s\",\"ts\":%llu.%03u,\"pid\":1,\"tid\":%lu%s",
+                first ? "" : ",", name, phase,
+                static_cast<unsigned long long>(ns / 1000), static_cast<unsigned>(ns % 1000),
+                static_cast<unsigned long>(record.threadId), (phase[0] == 'i') ? ",\"s\":\"t\"" : "");
+            json.append(line, len);
+            if (argName) {
+                len = std::snprintf(line, sizeof(line), ",\"args\":{\"%s\":%lu}",
+                    argName, static_cast<unsigned long>(record.arg));
+                json.append(line, len);
+            }
+            json += '}';
+            first = false;
+        });
+
+        json += "\n]}\n";
+        return json;
+    }
+
+private:
+    // Slot sequence once record index is complete; odd (one less) while it
+    // is being written, 0 if the slot was never used
+    static constexpr uint64_t Complete(uint64_t index) { return 2 * (index + 1); }
+
+    struct Slot {
+        std::atomic<uint64_t> sequence{ 0 };
+        std::atomic<TraceEvent> event{ TRACE_HOOK };
+        std::atomic<uint32_t> threadId{ 0 };
+        std::atomic<uint32_t> arg{ 0 };
+        std::atomic<int64_t> timestamp{ 0 };
+    };
+
+    Slot m_slots[Capacity];
+    std::atomic<uint64_t> m_next{ 0 };
+    std::atomic<uint64_t> m_dropped{ 0 };
+    int64_t m_base = 0;
+};
@@ -0,0 +1,309 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Animation table tests - the validator rejects known-bad transitions, and
+//  millions of random event sequences are replayed through Step() against a
+//  model of the timers, the window and the render queue, checking for
+//  redundant timers, presents that repeat the frame already on screen, stale
+//  content reaching the screen, and that every sequence settles back to
+//  hidden.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "OsdAnimTable.h"
+#include "TestUtil.h"
+
+#include <random>
+
+constexpr int FADE_SPEED = 25;          // Linear stand-in for CalculateNextAlpha
+
+static void StepMatchesTable()
+{
+    for (int state = 0; state < STATE_COUNT; state++) {
+        for (int event = 0; event < EV_COUNT; event++) {
+            AnimTransition t = Step(static_cast<AnimationState>(state), static_cast<AnimEvent>(event));
+            CHECK(t.legal == ANIM_TABLE[state][event].legal);
+            CHECK(t.next == ANIM_TABLE[state][event].next);
+            CHECK(t.actions == ANIM_TABLE[state][event].actions);
+        }
+    }
+    CHECK(!Step(STATE_COUNT, EV_SHOW).legal);
+    CHECK(!Step(STATE_HIDDEN, EV_COUNT).legal);
+}
+
+static void ValidatorRejectsBadTransitions()
+{
+    // Opaque present of the previous text while the new one renders
+    CHECK(!IsValidTransition(STATE_HIDDEN, EV_SHOW_INSTANT_PENDING,
+        Transition(STATE_VISIBLE, SHOW_OPAQUE_FROM_HIDDEN)));
+    // Showing the window early, even at alpha 0
+    CHECK(!IsValidTransition(STATE_HIDDEN, EV_SHOW_PENDING,
+        Transition(STATE_FADING_IN, SHOW_FADE_FROM_HIDDEN)));
+    // Restarting the stay countdown on stale content
+    CHECK(!IsValidTransition(STATE_VISIBLE, EV_SHOW_PENDING,
+        Transition(STATE_VISIBLE, ACT_POSITION | ACT_RESTART_STAY)));
+    // Leaving a waiting state without the content
+    CHECK(!IsValidTransition(STATE_PENDING_INSTANT, EV_SHOW_INSTANT_PENDING,
+        Transition(STATE_VISIBLE, SHOW_OPAQUE_FROM_HIDDEN)));
+    // Entering a waiting state with current content
+    CHECK(!IsValidTransition(STATE_HIDDEN, EV_SHOW, Transition(STATE_PENDING_FADE_IN, ACT_NONE)));
+    // Repeated frames: hiding a fade that never ticked (still alpha 0), and
+    // re-presenting opaque when a show interrupts a fade-out before its tick
+    CHECK(!IsValidTransition(STATE_FADE_IN_START, EV_SUPPRESS, Transition(STATE_HIDDEN, HIDE_FROM_ANIM)));
+    CHECK(!IsValidTransition(STATE_FADE_OUT_START, EV_SHOW, Transition(STATE_VISIBLE, SHOW_OPAQUE_FROM_ANIM)));
+    CHECK(!IsValidTransition(STATE_FADE_IN_START, EV_CONTENT_READY, Transition(STATE_FADE_IN_START, ACT_PRESENT)));
+    // Old content left on screen once the new one is ready
+    CHECK(!IsValidTransition(STATE_STALE_OPAQUE, EV_CONTENT_READY,
+        Transition(STATE_VISIBLE, ACT_POSITION | ACT_START_STAY)));
+    // Alpha level that doesn't match the next state
+    CHECK(!IsValidTransition(STATE_VISIBLE, EV_SHOW_PENDING, Transition(STATE_STALE_INSTANT, ACT_KILL_STAY)));
+    // Stray stay timer, missing present, double start
+    CHECK(!IsValidTransition(STATE_VISIBLE, EV_STAY_EXPIRED, Transition(STATE_FADING_OUT, ACT_START_ANIM)));
+    CHECK(!IsValidTransition(STATE_VISIBLE, EV_CONTENT_READY, Transition(STATE_VISIBLE, ACT_NONE)));
+    CHECK(!IsValidTransition(STATE_FADING_OUT, EV_SHOW, Transition(STATE_FADING_IN, ACT_POSITION | ACT_START_ANIM)));
+    // Unhandled show
+    CHECK(!IsCoveredTransition(STATE_STALE_FADE_IN, EV_SHOW, ILLEGAL));
+}
+
+// =============================================================================
+// Model - timers, window, alpha, and render generations (requested vs front)
+// =============================================================================
+
+enum Mode { MODE_FADE, MODE_INSTANT, MODE_SUPPRESSED };
+
+struct Model {
+    AnimationState state = STATE_HIDDEN;
+    bool animTimer = false;
+    bool stayTimer = false;
+    bool shown = false;
+    int alpha = 0;
+    Mode mode = MODE_FADE;
+
+    uint32_t requested = 0;             // Newest text asked for
+    uint32_t front = 0;                 // Text in the front surface
+
+    int presentedAlpha = 0;             // Last UpdateLayeredWindow (WinMain presents alpha 0)
+    uint32_t presentedGen = 0;
+
+    bool sawCurrentOpaque = false;      // Since the last show
+    uint64_t steps = 0;
+    uint64_t presents = 0;
+    uint64_t repeatedPresents = 0;
+
+    void Dispatch(AnimEvent event, int stepAlpha = 0)
+    {
+        AnimTransition t = Step(state, event);
+        steps++;
+        if (!t.legal) return;
+        uint32_t a = t.actions;
+        bool current = (front == requested);
+
+        // Same order as DispatchAnimEvent
+        if (a & ACT_KILL_ANIM) { CHECK(animTimer); animTimer = false; }
+        if (a & ACT_KILL_STAY) { CHECK(stayTimer); stayTimer = false; }
+        if (a & ACT_POSITION) CHECK(current);   // Never move stale text
+
+        if (a & ACT_SET_ALPHA) alpha = stepAlpha;
+        if (a & ACT_OPAQUE) alpha = 255;
+        if (a & ACT_TRANSPARENT) alpha = 0;
+        if (a & ACT_PRESENT) Present();
+
+        if (a & ACT_SHOW_WINDOW) { CHECK(!shown); CHECK(current); shown = true; }
+        if (a & ACT_HIDE_WINDOW) { CHECK(shown); shown = false; }
+
+        if (a & ACT_START_ANIM) { CHECK(!animTimer); animTimer = true; }
+        if (a & ACT_RESTART_ANIM) CHECK(animTimer);
+        if (a & ACT_START_STAY) { CHECK(!stayTimer); stayTimer = true; }
+        if (a & ACT_RESTART_STAY) CHECK(stayTimer);
+        if (a & (ACT_START_ANIM | ACT_RESTART_ANIM | ACT_START_STAY | ACT_RESTART_STAY)) CHECK(current);
+
+        state = t.next;
+
+        // The state says everything about timers and the window
+        CHECK(animTimer == AnimTimerRunsIn(state));
+        CHECK(stayTimer == StayTimerRunsIn(state));
+        CHECK(shown == WindowShownIn(state));
+        if (ContentPendingIn(state)) CHECK(!current);
+
+        // ... and what is on screen: the alpha level, and current content
+        // whenever anything is visible outside the stale states
+        AlphaLevel level = (presentedAlpha == 0) ? ALPHA_ZERO : (presentedAlpha == 255) ? ALPHA_OPAQUE : ALPHA_PARTIAL;
+        CHECK(level == PresentedAlphaIn(state));
+        if (shown && presentedAlpha > 0 && !StaleShownIn(state)) CHECK(presentedGen == requested);
+
+        if (shown && presentedAlpha == 255 && presentedGen == requested) sawCurrentOpaque = true;
+    }
+
+    void Present()
+    {
+        // Stale: old text made visible while the new one renders
+        if (alpha > 0) CHECK(front == requested);
+
+        // Redundant: the frame on screen already looks like this (content
+        // doesn't matter at alpha 0)
+        if (presentedAlpha == alpha && (alpha == 0 || presentedGen == front)) repeatedPresents++;
+
+        presentedAlpha = alpha;
+        presentedGen = front;
+        presents++;
+    }
+
+    // ShowIndicator, optionally with new text (SetIndicatorText requests a render)
+    void Show(Mode showMode, bool newText)
+    {
+        if (newText) requested++;
+        mode = showMode;
+        sawCurrentOpaque = false;
+
+        bool pending = (front != requested);
+        switch (mode) {
+        case MODE_SUPPRESSED: Dispatch(EV_SUPPRESS); break;
+        case MODE_INSTANT:    Dispatch(pending ? EV_SHOW_INSTANT_PENDING : EV_SHOW_INSTANT); break;
+        default:              Dispatch(pending ? EV_SHOW_PENDING : EV_SHOW); break;
+        }
+    }
+
+    // WM_RENDER_COMPLETE for the newest generation
+    void RenderComplete()
+    {
+        front = requested;
+        Dispatch(EV_CONTENT_READY);
+    }
+
+    void AnimTick()
+    {
+        bool fadeIn = FadesIn(state);
+        int target = fadeIn ? 255 : 0;
+        int next = fadeIn ? alpha + FADE_SPEED : alpha - FADE_SPEED;
+        next = (next > 255) ? 255 : (next < 0) ? 0 : next;
+        Dispatch((next == target) ? EV_FADE_DONE : EV_FADE_STEP, next);
+    }
+
+    void StayTick()
+    {
+        Dispatch((mode == MODE_INSTANT) ? EV_HIDE_NOW : EV_STAY_EXPIRED);
+    }
+};
+
+// Lets the render land and the timers run out; the indicator must end hidden,
+// after having shown the newest text fully if the last show wasn't suppressed
+static void Settle(Model& model)
+{
+    if (model.front != model.requested) model.RenderComplete();
+
+    for (int i = 0; i < 1000 && (model.animTimer || model.stayTimer); i++) {
+        if (model.animTimer) model.AnimTick();
+        else model.StayTick();
+    }
+
+    CHECK(!model.animTimer && !model.stayTimer);
+    CHECK(model.state == STATE_HIDDEN);
+    CHECK(!model.shown);
+    if (model.mode != MODE_SUPPRESSED && model.presents > 0) CHECK(model.sawCurrentOpaque);
+}
+
+static void RandomSequencesKeepInvariants()
+{
+    constexpr int SEQUENCES = 2000000;
+    constexpr int MAX_LENGTH = 24;
+    std::mt19937 rng(20261019);
+    uint64_t steps = 0;
+    uint64_t presents = 0;
+    uint64_t repeatedPresents = 0;
+    uint64_t strayTicks = 0;
+    uint64_t visited[STATE_COUNT] = {};
+
+    auto start = TestClock::now();
+    for (int sequence = 0; sequence < SEQUENCES; sequence++) {
+        Model model;
+        int length = 1 + static_cast<int>(rng() % MAX_LENGTH);
+
+        for (int i = 0; i < length; i++) {
+            uint32_t roll = rng() % 100;
+            if (roll < 30) {
+                model.Show(static_cast<Mode>(rng() % 3), (rng() & 3) != 0);
+            }
+            else if (roll < 50 && model.front != model.requested) {
+                model.RenderComplete();
+            }
+            else if (roll < 75 && model.animTimer) {
+                model.AnimTick();
+            }
+            else if (roll < 90 && model.stayTimer) {
+                model.StayTick();
+            }
+            else if (roll < 95) {
+                // A tick already queued before KillTimer must be ignored
+                AnimEvent stray;
+                if (!model.animTimer && (model.stayTimer || (rng() & 1))) {
+                    stray = (rng() & 1) ? EV_FADE_STEP : EV_FADE_DONE;
+                }
+                else {
+                    stray = (rng() & 1) ? EV_STAY_EXPIRED : EV_HIDE_NOW;
+                }
+                if (!model.animTimer || !model.stayTimer) {
+                    AnimationState before = model.state;
+                    CHECK(!Step(model.state, stray).legal);
+                    model.Dispatch(stray);
+                    CHECK(model.state == before);
+                    strayTicks++;
+                }
+            }
+            else {
+                model.Show(static_cast<Mode>(rng() % 3), false);
+            }
+            visited[model.state]++;
+        }
+
+        Settle(model);
+        steps += model.steps;
+        presents += model.presents;
+        repeatedPresents += model.repeatedPresents;
+    }
+    double seconds = ElapsedMs(start, TestClock::now()) / 1000.0;
+
+    for (int state = 0; state < STATE_COUNT; state++) CHECK(visited[state] > 0);
+
+    std::printf("    %d sequences, %llu transitions (%llu stray ticks), %llu presents "
+        "(%llu repeated frames): %.1f M transitions/s with the model\n", SEQUENCES,
+        static_cast<unsigned long long>(steps), static_cast<unsigned long long>(strayTicks),
+        static_cast<unsigned long long>(presents), static_cast<unsigned long long>(repeatedPresents),
+        steps / seconds / 1e6);
+    CHECK(repeatedPresents == 0);
+}
+
+static void BenchStep()
+{
+    constexpr uint32_t STEPS = 50000000;
+    constexpr uint32_t EVENTS = 1 << 16;
+    std::mt19937 rng(7);
+    static AnimEvent events[EVENTS];
+    for (AnimEvent& event : events) event = static_cast<AnimEvent>(rng() % EV_COUNT);
+
+    AnimationState state = STATE_HIDDEN;
+    uint32_t actions = 0;
+    uint32_t legal = 0;
+
+    auto start = TestClock::now();
+    for (uint32_t i = 0; i < STEPS; i++) {
+        AnimTransition t = Step(state, events[i & (EVENTS - 1)]);
+        if (t.legal) {
+            state = t.next;
+            actions ^= t.actions;
+            legal++;
+        }
+    }
+    double seconds = ElapsedMs(start, TestClock::now()) / 1000.0;
+
+    std::printf("    Step(): %.1f M transitions/s (%u legal, actions %08x)\n",
+        STEPS / seconds / 1e6, legal, actions);
+    CHECK(legal > 0);
+}
+
+int main()
+{
+    RUN_TEST(StepMatchesTable);
+    RUN_TEST(ValidatorRejectsBadTransitions);
+    RUN_TEST(RandomSequencesKeepInvariants);
+    RUN_TEST(BenchStep);
+    return 0;
+}
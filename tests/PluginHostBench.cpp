@@ -0,0 +1,265 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  PluginRegistry - registration checks, then a benchmark of the per-keystroke
+//  cost (KeyboardProc filter lookup + UI-thread dispatch) with 0, 1, 8 and
+//  32 plugins loaded.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "OsdPluginHost.h"
+#include "TestUtil.h"
+
+#include <cstring>
+#include <cwchar>
+#include <random>
+#include <vector>
+
+constexpr uint32_t VK_CAPITAL = 0x14;
+constexpr uint32_t VK_NUMLOCK = 0x90;
+constexpr uint32_t VK_FIRST_PLUGIN_KEY = 0x30;  // '0', '1', ... - one key per plugin
+
+struct FakePlugin {
+    uint32_t vkCode;
+    bool accept;
+    int calls;
+};
+
+static int OSD_CALL FakeFilter(void* context, uint32_t)
+{
+    return static_cast<FakePlugin*>(context)->accept ? 1 : 0;
+}
+
+static int OSD_CALL FakeGetState(void* context, uint32_t vkCode, OsdIndicatorState* state)
+{
+    auto* plugin = static_cast<FakePlugin*>(context);
+    plugin->calls++;
+    std::wmemcpy(state->label, L"Plugin", 7);
+    std::wmemcpy(state->status, L"ON", 3);
+    state->isOn = (vkCode != 0);
+    return 1;
+}
+
+static OsdIndicatorDesc MakeDesc(const uint32_t* vkCodes, uint32_t vkCount, void* context)
+{
+    OsdIndicatorDesc desc = {};
+    desc.structSize = sizeof(OsdIndicatorDesc);
+    desc.vkCodes = vkCodes;
+    desc.vkCount = vkCount;
+    desc.filter = FakeFilter;
+    desc.getState = FakeGetState;
+    desc.context = context;
+    return desc;
+}
+
+static void RegistrationRejectsBadDescriptors()
+{
+    PluginRegistry registry;
+    FakePlugin plugin = { 0x41, true, 0 };
+    uint32_t keys[] = { 0x41 };
+
+    OsdIndicatorDesc desc = MakeDesc(nullptr, 1, &plugin);
+    CHECK(registry.Register(&desc) == -1);              // Count without codes
+
+    uint32_t outOfRange[] = { 0x41, 256 };
+    desc = MakeDesc(outOfRange, 2, &plugin);
+    CHECK(registry.Register(&desc) == -1);
+
+    desc = MakeDesc(keys, 1, &plugin);
+    desc.getState = nullptr;
+    CHECK(registry.Register(&desc) == -1);
+
+    desc = MakeDesc(keys, 1, &plugin);
+    desc.structSize = sizeof(OsdIndicatorDesc) - 1;
+    CHECK(registry.Register(&desc) == -1);
+    CHECK(registry.Register(nullptr) == -1);
+    CHECK(registry.Count() == 0);
+    CHECK(!registry.Accepts(0x41));                     // Nothing half-registered
+
+    desc = MakeDesc(nullptr, 0, &plugin);               // notify-only indicator
+    CHECK(registry.Register(&desc) == 0);
+    desc = MakeDesc(keys, 1, &plugin);
+    CHECK(registry.Register(&desc) == 1);
+    CHECK(registry.Accepts(0x41));
+
+    for (int i = registry.Count(); i < OSD_MAX_INDICATORS; i++) {
+        CHECK(registry.Register(&desc) == i);
+    }
+    CHECK(registry.Register(&desc) == -1);              // Table full
+}
+
+static void DispatchHonorsFiltersAndOrder()
+{
+    PluginRegistry registry;
+    FakePlugin rejecting = { 0x41, false, 0 };
+    FakePlugin accepting = { 0x41, true, 0 };
+    uint32_t keys[] = { 0x41 };
+
+    OsdIndicatorDesc desc = MakeDesc(keys, 1, &rejecting);
+    CHECK(registry.Register(&desc) == 0);
+    desc = MakeDesc(keys, 1, &accepting);
+    CHECK(registry.Register(&desc) == 1);
+
+    OsdIndicatorState state;
+    CHECK(registry.DispatchKey(0x41, state));
+    CHECK(rejecting.calls == 0);
+    CHECK(accepting.calls == 1);
+    CHECK(std::wcscmp(state.label, L"Plugin") == 0);
+    CHECK(!registry.DispatchKey(0x42, state));
+    CHECK(!registry.DispatchKey(1000, state));
+
+    CHECK(registry.GetEventState(0, state));            // notify bypasses the filter
+    CHECK(!state.isOn);
+    CHECK(!registry.GetEventState(2, state));
+    CHECK(!registry.GetEventState(-1, state));
+
+    registry.Clear();
+    CHECK(!registry.DispatchKey(0x41, state));
+    CHECK(!registry.IsValid(0));
+}
+
+// A plugin whose OsdPluginInit registers and then returns 0 is unloaded;
+// LoadPlugins rolls its indicators back so the hook and dispatch forget it
+static void FailedInitIsRolledBack()
+{
+    PluginRegistry registry;
+    registry.AddKey(VK_CAPITAL);
+
+    FakePlugin kept = { 0x41, true, 0 };
+    FakePlugin failed = { 0x42, true, 0 };
+    uint32_t keptKeys[] = { 0x41 };
+    uint32_t failedKeys[] = { 0x41, 0x42, VK_CAPITAL };
+
+    OsdIndicatorDesc desc = MakeDesc(keptKeys, 1, &kept);
+    CHECK(registry.Register(&desc) == 0);
+
+    int registered = registry.Count();
+    desc = MakeDesc(failedKeys, 3, &failed);
+    CHECK(registry.Register(&desc) == 1);
+    CHECK(registry.Register(&desc) == 2);
+    registry.Truncate(registered);
+
+    CHECK(registry.Count() == 1);
+    CHECK(!registry.IsValid(1));
+    CHECK(!registry.Accepts(0x42));                     // Only the failed plugin watched it
+    CHECK(registry.Accepts(0x41));                      // Still watched by the kept one
+    CHECK(registry.Accepts(VK_CAPITAL));                // Built in
+
+    OsdIndicatorState state;
+    CHECK(!registry.DispatchKey(0x42, state));
+    CHECK(!registry.DispatchKey(VK_CAPITAL, state));
+    kept.accept = false;                                // Would fall through to id 1
+    CHECK(!registry.DispatchKey(0x41, state));
+    CHECK(!registry.GetEventState(1, state));
+    CHECK(failed.calls == 0);
+
+    // The freed slot is reused by the next plugin
+    desc = MakeDesc(&failedKeys[1], 1, &kept);
+    CHECK(registry.Register(&desc) == 1);
+    CHECK(registry.Accepts(0x42));
+}
+
+// Typing: mostly unwatched keys, with a watched key now and then
+static std::vector<uint32_t> MakeKeystrokes(size_t count)
+{
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<uint32_t> anyKey(0, 255);
+    std::vector<uint32_t> keys(count);
+    for (uint32_t& vkCode : keys) vkCode = anyKey(rng);
+    return keys;
+}
+
+static void BenchKeystrokeCost()
+{
+    constexpr size_t KEYSTROKES = 1 << 16;
+    constexpr int PASSES = 200;
+    const std::vector<uint32_t> keystrokes = MakeKeystrokes(KEYSTROKES);
+    const int pluginCounts[] = { 0, 1, 8, 32 };
+
+    std::printf("    %-8s %14s %14s %16s\n", "plugins", "lookup ns/key", "keys accepted", "dispatch ns/key");
+
+    for (int plugins : pluginCounts) {
+        PluginRegistry registry;
+        registry.AddKey(VK_CAPITAL);
+        registry.AddKey(VK_NUMLOCK);
+
+        std::vector<FakePlugin> fakes(plugins);
+        std::vector<uint32_t> keys(plugins);
+        for (int i = 0; i < plugins; i++) {
+            keys[i] = VK_FIRST_PLUGIN_KEY + i;
+            fakes[i] = { keys[i], true, 0 };
+            OsdIndicatorDesc desc = MakeDesc(&keys[i], 1, &fakes[i]);
+            CHECK(registry.Register(&desc) == i);
+        }
+
+        // KeyboardProc: filter every keystroke
+        size_t accepted = 0;
+        auto start = TestClock::now();
+        for (int pass = 0; pass < PASSES; pass++) {
+            for (uint32_t vkCode : keystrokes) accepted += registry.Accepts(vkCode);
+        }
+        double lookupNs = ElapsedMs(start, TestClock::now()) * 1e6 / (double(KEYSTROKES) * PASSES);
+
+        // WndProc: dispatch every key the hook posted
+        std::vector<uint32_t> posted;
+        for (uint32_t vkCode : keystrokes) {
+            if (registry.Accepts(vkCode)) posted.push_back(vkCode);
+        }
+
+        size_t claimed = 0;
+        size_t dispatched = 0;
+        OsdIndicatorState state;
+        start = TestClock::now();
+        for (int pass = 0; pass < PASSES; pass++) {
+            for (uint32_t vkCode : posted) claimed += registry.DispatchKey(vkCode, state);
+            dispatched += posted.size();
+        }
+        double dispatchNs = dispatched ? ElapsedMs(start, TestClock::now()) * 1e6 / dispatched : 0.0;
+
+        // Every plugin key is claimed by its plugin; lock keys aren't plugin keys
+        size_t expectedClaims = 0;
+        for (uint32_t vkCode : keystrokes) {
+            expectedClaims += (vkCode >= VK_FIRST_PLUGIN_KEY && vkCode < VK_FIRST_PLUGIN_KEY + uint32_t(plugins));
+        }
+        CHECK(claimed == expectedClaims * PASSES);
+        CHECK(accepted == dispatched);
+
+        std::printf("    %-8d %14.2f %13.2f%% %16.2f\n", plugins, lookupNs,
+            100.0 * accepted / (double(KEYSTROKES) * PASSES), dispatchNs);
+    }
+}
+
+// Worst case for dispatch: all 32 plugins watch the same key and only the
+// last one's filter accepts it
+static void BenchSharedKeyWorstCase()
+{
+    constexpr int DISPATCHES = 1000000;
+    PluginRegistry registry;
+    FakePlugin fakes[OSD_MAX_INDICATORS];
+    uint32_t key = 0x41;
+
+    for (int i = 0; i < OSD_MAX_INDICATORS; i++) {
+        fakes[i] = { key, i == OSD_MAX_INDICATORS - 1, 0 };
+        OsdIndicatorDesc desc = MakeDesc(&key, 1, &fakes[i]);
+        CHECK(registry.Register(&desc) == i);
+    }
+
+    OsdIndicatorState state;
+    size_t claimed = 0;
+    auto start = TestClock::now();
+    for (int i = 0; i < DISPATCHES; i++) claimed += registry.DispatchKey(key, state);
+    double ns = ElapsedMs(start, TestClock::now()) * 1e6 / DISPATCHES;
+
+    CHECK(claimed == DISPATCHES);
+    CHECK(fakes[OSD_MAX_INDICATORS - 1].calls == DISPATCHES);
+    std::printf("    32 plugins on one key, last one claims it: %.2f ns/dispatch\n", ns);
+}
+
+int main()
+{
+    RUN_TEST(RegistrationRejectsBadDescriptors);
+    RUN_TEST(DispatchHonorsFiltersAndOrder);
+    RUN_TEST(FailedInitIsRolledBack);
+    RUN_TEST(BenchKeystrokeCost);
+    RUN_TEST(BenchSharedKeyWorstCase);
+    return 0;
+}
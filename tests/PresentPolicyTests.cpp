@@ -0,0 +1,134 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Presentation policy tests - every foreground x power cell, the
+//  GAME_AWARE_PRESENTATION = false override, and per-mode frame counting.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "OsdPresentPolicy.h"
+#include "TestUtil.h"
+
+#include <cstring>
+
+// Written out independently of PRESENT_POLICY so a typo in either shows up
+static PresentMode ExpectedMode(ForegroundState foreground, PowerState power)
+{
+    switch (foreground) {
+    case FG_NORMAL:
+        return (power == POWER_AC) ? PRESENT_FULL : PRESENT_REDUCED;
+    case FG_BORDERLESS_FULLSCREEN:
+        return (power == POWER_AC) ? PRESENT_REDUCED : PRESENT_INSTANT;
+    case FG_EXCLUSIVE_FULLSCREEN:
+        return PRESENT_SUPPRESSED;
+    case FG_PRESENTATION:
+        return PRESENT_INSTANT;
+    default:
+        return PRESENT_MODE_COUNT;
+    }
+}
+
+static void EveryCellMatchesTheDocumentedPolicy()
+{
+    int cells = 0;
+    for (int fg = 0; fg < FG_STATE_COUNT; fg++) {
+        for (int power = 0; power < POWER_STATE_COUNT; power++) {
+            auto foreground = static_cast<ForegroundState>(fg);
+            auto powerState = static_cast<PowerState>(power);
+            CHECK(EvaluatePresentPolicy(foreground, powerState, true) == ExpectedMode(foreground, powerState));
+            cells++;
+        }
+    }
+    CHECK(cells == 12);
+}
+
+static void LowerPowerNeverAnimatesMore()
+{
+    // Modes are ordered from most to least work per show
+    for (int fg = 0; fg < FG_STATE_COUNT; fg++) {
+        for (int power = 1; power < POWER_STATE_COUNT; power++) {
+            auto foreground = static_cast<ForegroundState>(fg);
+            CHECK(EvaluatePresentPolicy(foreground, static_cast<PowerState>(power), true) >=
+                  EvaluatePresentPolicy(foreground, static_cast<PowerState>(power - 1), true));
+        }
+    }
+}
+
+static void OverrideKeepsFullAnimationEverywhere()
+{
+    for (int fg = 0; fg < FG_STATE_COUNT; fg++) {
+        for (int power = 0; power < POWER_STATE_COUNT; power++) {
+            CHECK(EvaluatePresentPolicy(static_cast<ForegroundState>(fg),
+                static_cast<PowerState>(power), false) == PRESENT_FULL);
+        }
+    }
+    static_assert(EvaluatePresentPolicy(FG_EXCLUSIVE_FULLSCREEN, POWER_SAVER, false) == PRESENT_FULL);
+    static_assert(EvaluatePresentPolicy(FG_EXCLUSIVE_FULLSCREEN, POWER_SAVER, true) == PRESENT_SUPPRESSED);
+}
+
+static void FramesAreCountedPerMode()
+{
+    PresentStats stats;
+    CHECK(stats.Total() == 0);
+
+    // A full fade-in (11 steps of FADE_SPEED 25 up to 255), the stay, and a
+    // fade-out on AC; then an instant show/hide in a borderless game on battery
+    constexpr int FADE_FRAMES = 11;
+    stats.BeginShow(EvaluatePresentPolicy(FG_NORMAL, POWER_AC, true));
+    for (int i = 0; i < FADE_FRAMES * 2; i++) stats.CountFrame();
+
+    stats.BeginShow(EvaluatePresentPolicy(FG_BORDERLESS_FULLSCREEN, POWER_BATTERY, true));
+    stats.CountFrame();                     // Opaque present
+    stats.CountFrame();                     // Transparent present before hide
+
+    stats.BeginShow(EvaluatePresentPolicy(FG_NORMAL, POWER_BATTERY, true));
+    for (int i = 0; i < 3; i++) stats.CountFrame();
+
+    CHECK(stats.frames[PRESENT_FULL] == FADE_FRAMES * 2);
+    CHECK(stats.frames[PRESENT_INSTANT] == 2);
+    CHECK(stats.frames[PRESENT_REDUCED] == 3);
+    CHECK(stats.frames[PRESENT_SUPPRESSED] == 0);
+    CHECK(stats.Total() == FADE_FRAMES * 2 + 5);
+}
+
+static void SuppressedHideCountsUnderTheShownMode()
+{
+    PresentStats stats;
+
+    // Fade-in on the desktop, then the user switches to an exclusive
+    // fullscreen game and a suppressed show hides the indicator
+    stats.BeginShow(EvaluatePresentPolicy(FG_NORMAL, POWER_AC, true));
+    for (int i = 0; i < 4; i++) stats.CountFrame();
+    stats.BeginShow(EvaluatePresentPolicy(FG_EXCLUSIVE_FULLSCREEN, POWER_AC, true));
+    stats.CountFrame();                     // Transparent present before hide
+
+    CHECK(stats.frames[PRESENT_FULL] == 5);
+    CHECK(stats.frames[PRESENT_SUPPRESSED] == 0);
+
+    // The next real show starts counting under its own mode
+    stats.BeginShow(EvaluatePresentPolicy(FG_PRESENTATION, POWER_AC, true));
+    stats.CountFrame();
+    CHECK(stats.frames[PRESENT_INSTANT] == 1);
+    CHECK(stats.Total() == 6);
+}
+
+static void ModeNamesAreDistinct()
+{
+    for (int a = 0; a < PRESENT_MODE_COUNT; a++) {
+        CHECK(std::strcmp(PresentModeName(static_cast<PresentMode>(a)), "unknown") != 0);
+        for (int b = a + 1; b < PRESENT_MODE_COUNT; b++) {
+            CHECK(std::strcmp(PresentModeName(static_cast<PresentMode>(a)),
+                              PresentModeName(static_cast<PresentMode>(b))) != 0);
+        }
+    }
+}
+
+int main()
+{
+    RUN_TEST(EveryCellMatchesTheDocumentedPolicy);
+    RUN_TEST(LowerPowerNeverAnimatesMore);
+    RUN_TEST(OverrideKeepsFullAnimationEverywhere);
+    RUN_TEST(FramesAreCountedPerMode);
+    RUN_TEST(SuppressedHideCountsUnderTheShownMode);
+    RUN_TEST(ModeNamesAreDistinct);
+    return 0;
+}
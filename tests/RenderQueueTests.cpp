@@ -0,0 +1,228 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  RenderQueue tests - claim / supersede / publish / swap protocol, plus a
+//  threaded run with deliberately slow renders that checks the UI-side
+//  present path stays fast and never shows a stale or half-drawn frame.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "OsdRenderQueue.h"
+#include "TestUtil.h"
+
+#include <atomic>
+#include <thread>
+
+using Queue = RenderQueue<int>;
+
+static void FirstFrameIsSwappedIn()
+{
+    Queue queue;
+    CHECK(!queue.IsContentPending());
+
+    CHECK(queue.Request(7) == 1);
+    CHECK(queue.IsContentPending());
+
+    Queue::Job job;
+    CHECK(queue.Claim(job));
+    CHECK(job.content == 7);
+    CHECK(job.generation == 1);
+    CHECK(job.surface == 1);                // Never the front surface
+
+    CHECK(queue.Publish(job));
+    CHECK(queue.Swap());
+    CHECK(queue.Front() == 1);
+    CHECK(!queue.IsContentPending());
+    CHECK(!queue.Swap());                   // Nothing new
+}
+
+static void NewerRequestSupersedesRenderInFlight()
+{
+    Queue queue;
+    Queue::Job first, second;
+
+    queue.Request(1);
+    CHECK(queue.Claim(first));
+    queue.Request(2);
+
+    CHECK(queue.IsSuperseded(first.generation));
+    CHECK(!queue.Publish(first));
+    CHECK(!queue.Swap());
+    CHECK(queue.Front() == 0);
+
+    CHECK(queue.Claim(second));
+    CHECK(second.content == 2);
+    CHECK(second.surface == first.surface); // Front hasn't moved
+    CHECK(!queue.IsSuperseded(second.generation));
+    CHECK(queue.Publish(second));
+    CHECK(queue.Swap());
+    CHECK(!queue.IsContentPending());
+}
+
+static void StaleReadyFrameIsNeverSwappedIn()
+{
+    Queue queue;
+    Queue::Job first, second;
+
+    queue.Request(1);
+    CHECK(queue.Claim(first));
+    CHECK(queue.Publish(first));
+
+    // New content arrives before the UI thread handled the first frame
+    queue.Request(2);
+    CHECK(!queue.Swap());
+    CHECK(queue.Front() == 0);
+    CHECK(queue.IsContentPending());
+
+    CHECK(queue.Claim(second));
+    CHECK(second.content == 2);
+    CHECK(queue.Publish(second));
+    CHECK(queue.Swap());
+    CHECK(queue.Front() == second.surface);
+}
+
+static void WorkerAlwaysGetsTheBackSurface()
+{
+    Queue queue;
+    Queue::Job job;
+
+    for (int i = 1; i <= 6; i++) {
+        queue.Request(i);
+        CHECK(queue.Claim(job));
+        CHECK(job.surface != queue.Front());
+        CHECK(queue.Publish(job));
+        CHECK(queue.Swap());
+        CHECK(queue.Front() == job.surface);
+    }
+}
+
+static void StopReleasesBlockedWorker()
+{
+    Queue queue;
+    std::atomic<bool> returned{ false };
+    std::atomic<bool> claimed{ true };
+
+    std::thread worker([&] {
+        Queue::Job job;
+        claimed = queue.Claim(job);
+        returned = true;
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    CHECK(!returned);
+    queue.Stop();
+    worker.join();
+    CHECK(returned);
+    CHECK(!claimed);
+}
+
+// The worker takes RENDER_MS per frame and new content arrives in bursts
+// faster than that, so most renders are superseded and the rest land in the
+// quiet gap between bursts. The UI side ticks like the fade timer
+// and must never wait on a render, tear, or show anything but the newest frame.
+static void PresentLatencyStaysBoundedWithSlowRenders()
+{
+    constexpr int PIXELS = 64;
+    constexpr int RENDER_MS = 50;           // Split in two halves
+    constexpr int TICK_MS = 10;             // ANIM_INTERVAL
+    constexpr int BURST_PERIOD_TICKS = 15;  // A burst every 150 ms...
+    constexpr int BURST_SPACING_TICKS = 3;  // ...of requests 30 ms apart
+    constexpr int BURST_LENGTH = 3;
+    constexpr int TICKS = 150;
+    constexpr double MAX_PRESENT_MS = 20.0; // Well under one render
+
+    Queue queue;
+    std::atomic<int> surfaces[2][PIXELS];
+    for (auto& surface : surfaces) {
+        for (auto& pixel : surface) pixel = 0;
+    }
+    std::atomic<int> posted{ 0 };           // Stands in for WM_RENDER_COMPLETE
+    std::atomic<int> superseded{ 0 };
+
+    std::thread worker([&] {
+        Queue::Job job;
+        while (queue.Claim(job)) {
+            bool completed = true;
+            for (int i = 0; i < PIXELS && completed; i++) {
+                surfaces[job.surface][i] = job.content;
+                if (i == PIXELS / 2) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(RENDER_MS / 2));
+                    completed = !queue.IsSuperseded(job.generation);
+                }
+            }
+            if (completed) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(RENDER_MS / 2));
+            }
+            if (!completed || !queue.Publish(job)) {
+                superseded++;
+                continue;
+            }
+            posted++;
+        }
+    });
+
+    int latestRequested = 0;
+    int frontValue = 0;
+    int swaps = 0;
+    double maxPresentMs = 0.0;
+    double totalPresentMs = 0.0;
+
+    auto presentFrame = [&] {
+        auto start = TestClock::now();
+
+        if (posted.exchange(0) > 0 && queue.Swap()) {
+            swaps++;
+            frontValue = surfaces[queue.Front()][0];
+            CHECK(frontValue == latestRequested);   // Only the newest frame is swapped in
+        }
+
+        // "UpdateLayeredWindow": read the whole front surface
+        int front = queue.Front();
+        for (int i = 0; i < PIXELS; i++) {
+            CHECK(surfaces[front][i] == frontValue);   // No tearing, no worker writes
+        }
+
+        double ms = ElapsedMs(start, TestClock::now());
+        maxPresentMs = (ms > maxPresentMs) ? ms : maxPresentMs;
+        totalPresentMs += ms;
+    };
+
+    for (int tick = 0; tick < TICKS; tick++) {
+        int phase = tick % BURST_PERIOD_TICKS;
+        if (phase % BURST_SPACING_TICKS == 0 && phase / BURST_SPACING_TICKS < BURST_LENGTH) {
+            latestRequested = tick + 1;
+            queue.Request(latestRequested);
+        }
+        presentFrame();
+        std::this_thread::sleep_for(std::chrono::milliseconds(TICK_MS));
+    }
+
+    // Let the last request land
+    auto deadline = TestClock::now() + std::chrono::seconds(3);
+    while (queue.IsContentPending() && TestClock::now() < deadline) {
+        presentFrame();
+        std::this_thread::sleep_for(std::chrono::milliseconds(TICK_MS));
+    }
+    CHECK(!queue.IsContentPending());
+    CHECK(frontValue == latestRequested);
+
+    queue.Stop();
+    worker.join();
+
+    std::printf("    present: max %.3f ms, avg %.4f ms over %d ticks; render %d ms; "
+        "%d swaps, %d superseded renders\n",
+        maxPresentMs, totalPresentMs / TICKS, TICKS, RENDER_MS, swaps, superseded.load());
+    CHECK(maxPresentMs < MAX_PRESENT_MS);
+    CHECK(superseded > 0);
+    CHECK(swaps > 1);
+}
+
+int main()
+{
+    RUN_TEST(FirstFrameIsSwappedIn);
+    RUN_TEST(NewerRequestSupersedesRenderInFlight);
+    RUN_TEST(StaleReadyFrameIsNeverSwappedIn);
+    RUN_TEST(WorkerAlwaysGetsTheBackSurface);
+    RUN_TEST(StopReleasesBlockedWorker);
+    RUN_TEST(PresentLatencyStaysBoundedWithSlowRenders);
+    return 0;
+}
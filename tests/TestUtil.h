@@ -0,0 +1,33 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  OSD LOCK INDICATOR - Minimal test helpers (no framework dependency)
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#define CHECK(cond)                                                             \
+    do {                                                                        \
+        if (!(cond)) {                                                          \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            std::exit(1);                                                       \
+        }                                                                       \
+    } while (0)
+
+#define RUN_TEST(fn)                                                            \
+    do {                                                                        \
+        std::printf("[ RUN  ] %s\n", #fn);                                      \
+        fn();                                                                   \
+        std::printf("[  OK  ] %s\n", #fn);                                      \
+    } while (0)
+
+using TestClock = std::chrono::steady_clock;
+
+inline double ElapsedMs(TestClock::time_point start, TestClock::time_point end)
+{
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
@@ -0,0 +1,426 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  TraceRing tests - the exported JSON is parsed back and compared with what
+//  was recorded (including after the ring wraps, and past 2^32 records),
+//  concurrent writers never produce torn records, and the per-event cost of
+//  Record() is measured.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "OsdTrace.h"
+#include "TestUtil.h"
+
+#include <cstring>
+#include <functional>
+#include <map>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// =============================================================================
+// Minimal JSON parser - just enough to read the export back
+// =============================================================================
+
+struct Json {
+    enum Type { NUL, BOOL, NUMBER, STRING, ARRAY, OBJECT } type = NUL;
+    bool boolean = false;
+    double number = 0.0;
+    std::string text;
+    std::vector<Json> items;
+    std::map<std::string, Json> members;
+
+    const Json& operator[](const char* key) const
+    {
+        static const Json missing;
+        auto it = members.find(key);
+        return (it != members.end()) ? it->second : missing;
+    }
+    bool Has(const char* key) const { return members.count(key) != 0; }
+};
+
+class JsonParser {
+public:
+    explicit JsonParser(const std::string& input) : m_p(input.c_str()), m_end(m_p + input.size()) {}
+
+    // Returns false on any syntax error or trailing garbage
+    bool Parse(Json& out)
+    {
+        if (!Value(out)) return false;
+        SkipSpace();
+        return m_p == m_end;
+    }
+
+private:
+    void SkipSpace()
+    {
+        while (m_p < m_end && (*m_p == ' ' || *m_p == '\n' || *m_p == '\r' || *m_p == '\t')) m_p++;
+    }
+
+    bool Literal(const char* word)
+    {
+        size_t len = std::strlen(word);
+        if (size_t(m_end - m_p) < len || std::strncmp(m_p, word, len) != 0) return false;
+        m_p += len;
+        return true;
+    }
+
+    bool String(std::string& out)
+    {
+        if (*m_p++ != '"') return false;
+        while (m_p < m_end && *m_p != '"') {
+            if (static_cast<unsigned char>(*m_p) < 0x20) return false;
+            if (*m_p == '\\') {
+                if (++m_p == m_end) return false;
+                switch (*m_p) {
+                case '"': case '\\': case '/': out += *m_p; break;
+                case 'n': out += '\n'; break;
+                case 't': out += '\t'; break;
+                default: return false;      // The exporter never needs more
+                }
+                m_p++;
+            }
+            else {
+                out += *m_p++;
+            }
+        }
+        if (m_p == m_end) return false;
+        m_p++;
+        return true;
+    }
+
+    bool Number(double& out)
+    {
+        const char* start = m_p;
+        if (m_p < m_end && *m_p == '-') m_p++;
+        if (m_p == m_end || *m_p < '0' || *m_p > '9') return false;
+        while (m_p < m_end && ((*m_p >= '0' && *m_p <= '9') || *m_p == '.' || *m_p == 'e' ||
+                               *m_p == 'E' || *m_p == '+' || *m_p == '-')) m_p++;
+        out = std::strtod(std::string(start, m_p).c_str(), nullptr);
+        return true;
+    }
+
+    bool Value(Json& out)
+    {
+        SkipSpace();
+        if (m_p == m_end) return false;
+
+        switch (*m_p) {
+        case '{':
+            out.type = Json::OBJECT;
+            m_p++;
+            SkipSpace();
+            if (m_p < m_end && *m_p == '}') { m_p++; return true; }
+            for (;;) {
+                std::string key;
+                SkipSpace();
+                if (m_p == m_end || !String(key)) return false;
+                SkipSpace();
+                if (m_p == m_end || *m_p++ != ':') return false;
+                if (out.members.count(key) || !Value(out.members[key])) return false;
+                SkipSpace();
+                if (m_p == m_end) return false;
+                if (*m_p == '}') { m_p++; return true; }
+                if (*m_p++ != ',') return false;
+            }
+        case '[':
+            out.type = Json::ARRAY;
+            m_p++;
+            SkipSpace();
+            if (m_p < m_end && *m_p == ']') { m_p++; return true; }
+            for (;;) {
+                out.items.emplace_back();
+                if (!Value(out.items.back())) return false;
+                SkipSpace();
+                if (m_p == m_end) return false;
+                if (*m_p == ']') { m_p++; return true; }
+                if (*m_p++ != ',') return false;
+            }
+        case '"':
+            out.type = Json::STRING;
+            return String(out.text);
+        case 't':
+            out.type = Json::BOOL;
+            out.boolean = true;
+            return Literal("true");
+        case 'f':
+            out.type = Json::BOOL;
+            return Literal("false");
+        case 'n':
+            return Literal("null");
+        default:
+            out.type = Json::NUMBER;
+            return Number(out.number);
+        }
+    }
+
+    const char* m_p;
+    const char* m_end;
+};
+
+static Json ParseOrFail(const std::string& text)
+{
+    Json json;
+    CHECK(JsonParser(text).Parse(json));
+    CHECK(json.type == Json::OBJECT);
+    CHECK(json["traceEvents"].type == Json::ARRAY);
+    return json;
+}
+
+static void ParserRejectsMalformedInput()
+{
+    const char* bad[] = { "", "{", "{\"a\":}", "[1,]", "{\"a\":1,}", "{\"a\" 1}", "[1] x", "{\"a\":1,\"a\":2}" };
+    for (const char* text : bad) {
+        Json json;
+        CHECK(!JsonParser(text).Parse(json));
+    }
+}
+
+// =============================================================================
+// Fake platform - the test decides the clock and thread id per thread
+// =============================================================================
+
+struct FakeTracePlatform {
+    static thread_local int64_t now;
+    static thread_local uint32_t threadId;
+
+    static int64_t Now() { return now; }
+    static int64_t Frequency() { return 1000000000; }  // Ticks are nanoseconds
+    static uint32_t ThreadId() { return threadId; }
+};
+
+thread_local int64_t FakeTracePlatform::now = 0;
+thread_local uint32_t FakeTracePlatform::threadId = 1;
+
+constexpr uint32_t TEST_CAPACITY = 64;
+using TestRing = TraceRing<FakeTracePlatform, TEST_CAPACITY>;
+
+static std::vector<const Json*> NonMetadataEvents(const Json& json)
+{
+    std::vector<const Json*> events;
+    for (const Json& event : json["traceEvents"].items) {
+        if (event["ph"].text != "M") events.push_back(&event);
+    }
+    return events;
+}
+
+static void ExportRoundTripsThroughParser()
+{
+    auto ring = std::make_unique<TestRing>();
+    ring->SetBase(1000);
+    FakeTracePlatform::threadId = 7;
+
+    const TraceEvent events[] = {
+        TRACE_HOOK, TRACE_POST, TRACE_DISPATCH, TRACE_SHOW, TRACE_RENDER_BEGIN,
+        TRACE_RENDER_END, TRACE_PRESENT_BEGIN, TRACE_PRESENT_END, TRACE_TIMER, TRACE_STATE,
+    };
+    const char* names[] = {
+        "KeyboardProc", "PostMessage", "WndProc", "ShowIndicator", "Render",
+        "Render", "UpdateLayeredWindow", "UpdateLayeredWindow", "WM_TIMER", "animState",
+    };
+    const char* phases[] = { "i", "i", "i", "i", "B", "E", "B", "E", "i", "C" };
+    constexpr int EVENT_KINDS = sizeof(events) / sizeof(events[0]);
+    static_assert(EVENT_KINDS == TRACE_EVENT_COUNT, "Cover every event kind");
+
+    for (int i = 0; i < EVENT_KINDS; i++) {
+        FakeTracePlatform::now = 1000 + 1500 * i + 7;   // 1.5 us apart, sub-us remainder
+        ring->Record(events[i], 100 + i);
+    }
+
+    const TraceThreadName threads[] = { { 7, "UI" }, { 9, "Render worker" } };
+    Json json = ParseOrFail(ring->ExportJson(threads, 2, "\"presentedFrames\":{\"full\":12,\"instant\":3}"));
+
+    CHECK(json["displayTimeUnit"].text == "ms");
+    CHECK(json["otherData"]["presentedFrames"]["full"].number == 12);
+    CHECK(json["otherData"]["presentedFrames"]["instant"].number == 3);
+
+    const Json& metadata = json["traceEvents"].items[0];
+    CHECK(metadata["name"].text == "thread_name");
+    CHECK(metadata["ph"].text == "M");
+    CHECK(metadata["tid"].number == 7);
+    CHECK(metadata["args"]["name"].text == "UI");
+    CHECK(json["traceEvents"].items[1]["args"]["name"].text == "Render worker");
+
+    auto recorded = NonMetadataEvents(json);
+    CHECK(recorded.size() == EVENT_KINDS);
+    for (int i = 0; i < EVENT_KINDS; i++) {
+        const Json& event = *recorded[i];
+        CHECK(event["name"].text == names[i]);
+        CHECK(event["ph"].text == phases[i]);
+        CHECK(event["pid"].number == 1);
+        CHECK(event["tid"].number == 7);
+        CHECK(event["ts"].number * 1000.0 > 1500.0 * i + 6.5);
+        CHECK(event["ts"].number * 1000.0 < 1500.0 * i + 7.5);
+        CHECK(event.Has("s") == (phases[i][0] == 'i'));     // Instant events are thread-scoped
+
+        if (events[i] == TRACE_HOOK || events[i] == TRACE_PRESENT_END) {
+            CHECK(!event.Has("args"));
+        }
+        else {
+            CHECK(event["args"].type == Json::OBJECT);
+            CHECK(event["args"].members.size() == 1);
+            CHECK(event["args"].members.begin()->second.number == 100 + i);
+        }
+    }
+
+    // Empty ring, no threads, no otherData is still a valid document
+    auto empty = std::make_unique<TestRing>();
+    Json emptyJson = ParseOrFail(empty->ExportJson(nullptr, 0, nullptr));
+    CHECK(emptyJson["traceEvents"].items.empty());
+    CHECK(emptyJson["otherData"].members.empty());
+}
+
+static void ExportAfterWraparoundKeepsNewestRecords()
+{
+    auto ring = std::make_unique<TestRing>();
+    const uint32_t TOTAL = TEST_CAPACITY * 3 + 17;
+
+    for (uint32_t i = 0; i < TOTAL; i++) {
+        FakeTracePlatform::now = int64_t(i) * 1000;     // ts = i microseconds
+        ring->Record(TRACE_TIMER, i);
+    }
+
+    Json json = ParseOrFail(ring->ExportJson(nullptr, 0, nullptr));
+    auto recorded = NonMetadataEvents(json);
+    CHECK(recorded.size() == TEST_CAPACITY);
+
+    for (uint32_t k = 0; k < TEST_CAPACITY; k++) {
+        uint32_t expected = TOTAL - TEST_CAPACITY + k;  // Oldest surviving first
+        CHECK((*recorded[k])["args"]["id"].number == expected);
+        CHECK((*recorded[k])["ts"].number == expected);
+    }
+}
+
+// A long-running instance passes 2^32 records; the export must stay full and
+// ordered across that point, including the record at index 0xFFFFFFFF
+static void ExportPast32BitIndexKeepsFullRing()
+{
+    auto ring = std::make_unique<TestRing>();
+    const uint64_t FIRST = uint64_t(UINT32_MAX) - TEST_CAPACITY / 2;
+    ring->SkipTo(FIRST);
+
+    for (uint32_t k = 0; k < TEST_CAPACITY * 2; k++) {
+        uint64_t index = FIRST + k;
+        FakeTracePlatform::now = int64_t(k) * 1000;
+        ring->Record(TRACE_TIMER, uint32_t(index));
+
+        // Every export right after the 32-bit boundary holds all records so far
+        Json json = ParseOrFail(ring->ExportJson(nullptr, 0, nullptr));
+        auto recorded = NonMetadataEvents(json);
+        uint32_t expectedCount = (k + 1 < TEST_CAPACITY) ? k + 1 : TEST_CAPACITY;
+        CHECK(recorded.size() == expectedCount);
+        CHECK((*recorded.back())["args"]["id"].number == double(uint32_t(index)));
+        CHECK((*recorded.back())["ts"].number == k);
+    }
+    CHECK(ring->Dropped() == 0);
+}
+
+// Each record carries its own checksum (arg == timestamp == thread-local
+// counter, tid == writer), so a record torn by a concurrent overwrite would
+// show up as a mismatch in the export.
+static void ConcurrentWritersNeverProduceTornRecords()
+{
+    constexpr int WRITERS = 4;
+    constexpr uint32_t PER_WRITER = 200000;
+    auto ring = std::make_unique<TestRing>();
+    std::atomic<bool> done{ false };
+
+    std::vector<std::thread> writers;
+    for (int w = 0; w < WRITERS; w++) {
+        writers.emplace_back([&, w] {
+            FakeTracePlatform::threadId = 100 + w;
+            for (uint32_t i = 0; i < PER_WRITER; i++) {
+                uint32_t value = (uint32_t(w) << 24) | i;
+                FakeTracePlatform::now = int64_t(value) * 1000;
+                ring->Record(TRACE_DISPATCH, value);
+            }
+        });
+    }
+
+    int exports = 0;
+    size_t checked = 0;
+    std::thread exporter([&] {
+        while (!done) {
+            Json json = ParseOrFail(ring->ExportJson(nullptr, 0, nullptr));
+            for (const Json* event : NonMetadataEvents(json)) {
+                auto value = static_cast<uint32_t>((*event)["args"]["msg"].number);
+                CHECK((*event)["ts"].number == double(value));
+                CHECK((*event)["tid"].number == 100 + (value >> 24));
+                CHECK((*event)["name"].text == "WndProc");
+                checked++;
+            }
+            exports++;
+        }
+    });
+
+    for (auto& writer : writers) writer.join();
+    done = true;
+    exporter.join();
+
+    std::printf("    %d exports, %zu records checked while %d writers ran, %llu dropped\n",
+        exports, checked, WRITERS, static_cast<unsigned long long>(ring->Dropped()));
+    CHECK(exports > 0);
+}
+
+// =============================================================================
+// Per-event cost
+// =============================================================================
+
+struct SteadyClockTracePlatform {
+    static int64_t Now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+    static int64_t Frequency() { return 1000000000; }
+    static uint32_t ThreadId()
+    {
+        static thread_local uint32_t id = uint32_t(std::hash<std::thread::id>()(std::this_thread::get_id()));
+        return id;
+    }
+};
+
+template <typename Ring>
+static double MeasureRecordNs(Ring& ring, int threads, uint32_t perThread)
+{
+    std::vector<std::thread> workers;
+    auto start = TestClock::now();
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&] {
+            for (uint32_t i = 0; i < perThread; i++) ring.Record(TRACE_PRESENT_BEGIN, i);
+        });
+    }
+    for (auto& worker : workers) worker.join();
+    return ElapsedMs(start, TestClock::now()) * 1e6 / perThread;
+}
+
+static void BenchRecordCost()
+{
+    constexpr uint32_t EVENTS = 5000000;
+    auto fakeRing = std::make_unique<TraceRing<FakeTracePlatform, 2048>>();
+    auto clockRing = std::make_unique<TraceRing<SteadyClockTracePlatform, 2048>>();
+
+    double ringOnly = MeasureRecordNs(*fakeRing, 1, EVENTS);
+    double withClock = MeasureRecordNs(*clockRing, 1, EVENTS);
+    double contended = MeasureRecordNs(*clockRing, 4, EVENTS / 4);
+
+    std::printf("    Record(): %.2f ns ring only, %.2f ns with steady_clock, "
+        "%.2f ns per event per thread with 4 threads contending\n", ringOnly, withClock, contended);
+
+    // The export must still see a full ring afterwards, less any record a
+    // writer dropped because a preempted one a lap behind held its slot
+    Json json = ParseOrFail(clockRing->ExportJson(nullptr, 0, nullptr));
+    size_t exported = NonMetadataEvents(json).size();
+    CHECK(exported <= 2048);
+    CHECK(exported + clockRing->Dropped() >= 2048);
+}
+
+int main()
+{
+    RUN_TEST(ParserRejectsMalformedInput);
+    RUN_TEST(ExportRoundTripsThroughParser);
+    RUN_TEST(ExportAfterWraparoundKeepsNewestRecords);
+    RUN_TEST(ExportPast32BitIndexKeepsFullRing);
+    RUN_TEST(ConcurrentWritersNeverProduceTornRecords);
+    RUN_TEST(BenchRecordCost);
+    return 0;
+}